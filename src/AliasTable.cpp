@@ -0,0 +1,67 @@
+#include "AliasTable.h"
+
+/**
+ * @brief Rebuilds the table from a list of non-negative weights.
+ *
+ * @param weights The weight of each index.
+ */
+void AliasTable::build(const std::vector<double> &weights)
+{
+    const int n = static_cast<int>(weights.size());
+    m_probability.assign(n, 1.0);
+    m_alias.assign(n, 0);
+    if (n == 0) {
+        return;
+    }
+
+    double total = 0.0;
+    for (double w : weights) {
+        total += (w > 0.0) ? w : 0.0;
+    }
+    if (total <= 0.0) {
+        // Degenerate input: keep every column, which is a uniform distribution
+        for (int i = 0; i < n; ++i) {
+            m_alias[i] = i;
+        }
+        return;
+    }
+
+    // Scale so the average column holds exactly 1.0
+    m_scaled.resize(n);
+    m_small.clear();
+    m_large.clear();
+    for (int i = 0; i < n; ++i) {
+        m_scaled[i] = ((weights[i] > 0.0) ? weights[i] : 0.0) * n / total;
+        if (m_scaled[i] < 1.0) {
+            m_small.push_back(i);
+        } else {
+            m_large.push_back(i);
+        }
+    }
+
+    // Pair every under-full column with an over-full one that tops it up
+    while (!m_small.empty() && !m_large.empty()) {
+        int less = m_small.back();
+        m_small.pop_back();
+        int more = m_large.back();
+
+        m_probability[less] = m_scaled[less];
+        m_alias[less] = more;
+
+        m_scaled[more] = (m_scaled[more] + m_scaled[less]) - 1.0;
+        if (m_scaled[more] < 1.0) {
+            m_large.pop_back();
+            m_small.push_back(more);
+        }
+    }
+
+    // Whatever is left is full up to floating point error
+    for (int i : m_large) {
+        m_probability[i] = 1.0;
+        m_alias[i] = i;
+    }
+    for (int i : m_small) {
+        m_probability[i] = 1.0;
+        m_alias[i] = i;
+    }
+}
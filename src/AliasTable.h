@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "RandomGen.h"
+
+/**
+ * @class AliasTable
+ * @brief Samples indices from a discrete weighted distribution in O(1).
+ *
+ * Implements Walker's alias method (with Vose's O(n) construction). Building the table costs
+ * O(n) for n weights; every draw afterwards needs one uniform index and one uniform double.
+ */
+class AliasTable {
+public:
+    /**
+     * @brief Constructor for the AliasTable class. The table starts empty.
+     */
+    AliasTable() = default;
+
+    /**
+     * @brief Rebuilds the table from a list of non-negative weights.
+     *
+     * The internal buffers are reused, so rebuilding a table of the same size does not allocate.
+     * If every weight is zero the table falls back to a uniform distribution.
+     *
+     * @param weights The weight of each index.
+     */
+    void build(const std::vector<double> &weights);
+
+    /**
+     * @brief Draws one index according to the weights the table was built from.
+     *
+     * @param rng The random number generator to draw from.
+     * @return An index in [0, size()).
+     */
+    int sample(RandomGen &rng) const {
+        int column = rng.randomInt(0, static_cast<int>(m_probability.size()) - 1);
+        return rng.randomDouble(0.0, 1.0) < m_probability[column] ? column : m_alias[column];
+    }
+
+    /**
+     * @brief Gets the number of entries in the table.
+     *
+     * @return The number of entries.
+     */
+    int size() const { return static_cast<int>(m_probability.size()); }
+
+    /**
+     * @brief Checks whether the table has been built.
+     *
+     * @return True if the table holds no entries, false otherwise.
+     */
+    bool empty() const { return m_probability.empty(); }
+
+private:
+    std::vector<double> m_probability; ///< Probability of keeping the drawn column.
+    std::vector<int> m_alias; ///< Index returned when the drawn column is rejected.
+    std::vector<double> m_scaled; ///< Scratch buffer of weights scaled to mean 1.
+    std::vector<int> m_small; ///< Scratch worklist of under-full columns.
+    std::vector<int> m_large; ///< Scratch worklist of over-full columns.
+};
@@ -0,0 +1,273 @@
+#include "AllocationTracker.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+
+const int kPhases = static_cast<int>(AllocationPhase::Count);
+
+thread_local AllocationPhase t_phase = AllocationPhase::Other;
+
+const char *const kPhaseNames[kPhases] = {
+    "other", "spawn", "update", "routing", "repair", "publish", "statistics", "logging", "rendering"
+};
+
+#ifdef TRAFFICSIM_ALLOC_TRACKING
+
+const int kMaxThreads = 256; ///< Threads beyond kMaxThreads - 1 at a time share the last counter block.
+const int kOverflowBlock = kMaxThreads - 1; ///< Never leased; shared by the threads that find no free block.
+
+/**
+ * @brief Counters of one thread, padded to its own cache lines.
+ */
+struct alignas(64) ThreadCounters {
+    std::atomic<std::uint64_t> allocations[kPhases];
+    std::atomic<std::uint64_t> allocatedBytes[kPhases];
+    std::atomic<std::uint64_t> frees[kPhases];
+    std::atomic<std::uint64_t> freedBytes[kPhases];
+};
+
+// Zero-initialized before any dynamic initialization, so the hooks work during static init too
+ThreadCounters g_blocks[kMaxThreads];
+std::atomic<bool> g_leased[kMaxThreads];
+std::atomic<int> g_blockCount(0); ///< One past the highest block ever used.
+std::atomic<std::int64_t> g_liveBytes(0);
+std::atomic<std::int64_t> g_peakBytes(0);
+
+thread_local ThreadCounters *t_counters = nullptr;
+
+/**
+ * @brief Returns the thread's counter block to the pool when the thread exits.
+ *
+ * Counters are cumulative, so the next thread to lease the block continues from its totals; the
+ * process-wide sums stay monotonic and per-thread readers only ever take differences.
+ */
+struct BlockLease {
+    int index = -1; ///< The leased block, -1 if none.
+
+    ~BlockLease() {
+        // Frees made by later thread-exit destructors go to the shared block
+        t_counters = &g_blocks[kOverflowBlock];
+        if (index >= 0 && index != kOverflowBlock) {
+            g_leased[index].store(false, std::memory_order_release);
+        }
+    }
+};
+
+thread_local BlockLease t_lease;
+
+/**
+ * @brief Bookkeeping stored in front of every tracked block.
+ */
+struct Header {
+    std::size_t size; ///< Bytes requested by the caller.
+    int phase; ///< Phase the block is charged to.
+};
+
+// Keeps the returned pointer as aligned as malloc's
+const std::size_t kHeaderSize = 16;
+static_assert(sizeof(Header) <= kHeaderSize, "allocation header does not fit");
+
+// Leases the lowest free block to the calling thread, or the shared one if all are taken
+ThreadCounters *leaseBlock()
+{
+    int index = kOverflowBlock;
+    for (int b = 0; b < kOverflowBlock; ++b) {
+        bool expected = false;
+        if (!g_leased[b].load(std::memory_order_relaxed)
+            && g_leased[b].compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            index = b;
+            break;
+        }
+    }
+    int used = g_blockCount.load(std::memory_order_relaxed);
+    while (used <= index && !g_blockCount.compare_exchange_weak(used, index + 1, std::memory_order_relaxed)) {
+    }
+    t_lease.index = index;
+    t_counters = &g_blocks[index];
+    return t_counters;
+}
+
+ThreadCounters &counters()
+{
+    ThreadCounters *block = t_counters;
+    return block ? *block : *leaseBlock();
+}
+
+// Adds one block's counters to out
+void accumulate(const ThreadCounters &block, AllocationSnapshot &out)
+{
+    for (int p = 0; p < kPhases; ++p) {
+        out.phases[p].allocations += block.allocations[p].load(std::memory_order_relaxed);
+        out.phases[p].allocatedBytes += block.allocatedBytes[p].load(std::memory_order_relaxed);
+        out.phases[p].frees += block.frees[p].load(std::memory_order_relaxed);
+        out.phases[p].freedBytes += block.freedBytes[p].load(std::memory_order_relaxed);
+    }
+}
+
+void *allocate(std::size_t size) noexcept
+{
+    char *raw = static_cast<char *>(std::malloc(size + kHeaderSize));
+    if (!raw) {
+        return nullptr;
+    }
+    Header *header = reinterpret_cast<Header *>(raw);
+    header->size = size;
+    header->phase = static_cast<int>(t_phase);
+
+    ThreadCounters &block = counters();
+    block.allocations[header->phase].fetch_add(1, std::memory_order_relaxed);
+    block.allocatedBytes[header->phase].fetch_add(size, std::memory_order_relaxed);
+
+    std::int64_t live = g_liveBytes.fetch_add(static_cast<std::int64_t>(size), std::memory_order_relaxed)
+                      + static_cast<std::int64_t>(size);
+    std::int64_t peak = g_peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !g_peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    return raw + kHeaderSize;
+}
+
+void release(void *pointer) noexcept
+{
+    if (!pointer) {
+        return;
+    }
+    char *raw = static_cast<char *>(pointer) - kHeaderSize;
+    const Header *header = reinterpret_cast<const Header *>(raw);
+
+    ThreadCounters &block = counters();
+    block.frees[header->phase].fetch_add(1, std::memory_order_relaxed);
+    block.freedBytes[header->phase].fetch_add(header->size, std::memory_order_relaxed);
+    g_liveBytes.fetch_sub(static_cast<std::int64_t>(header->size), std::memory_order_relaxed);
+    std::free(raw);
+}
+
+void *allocateOrThrow(std::size_t size)
+{
+    for (;;) {
+        void *pointer = allocate(size);
+        if (pointer) {
+            return pointer;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+#endif // TRAFFICSIM_ALLOC_TRACKING
+
+} // namespace
+
+#ifdef TRAFFICSIM_ALLOC_TRACKING
+
+// ----------------------------------------------------------------
+//   Replaced global allocation functions
+// ----------------------------------------------------------------
+void *operator new(std::size_t size) { return allocateOrThrow(size); }
+void *operator new[](std::size_t size) { return allocateOrThrow(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return allocate(size); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return allocate(size); }
+void operator delete(void *pointer) noexcept { release(pointer); }
+void operator delete[](void *pointer) noexcept { release(pointer); }
+void operator delete(void *pointer, const std::nothrow_t &) noexcept { release(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept { release(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { release(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept { release(pointer); }
+
+#endif // TRAFFICSIM_ALLOC_TRACKING
+
+// ----------------------------------------------------------------
+//   AllocationTracker
+// ----------------------------------------------------------------
+bool AllocationTracker::available()
+{
+#ifdef TRAFFICSIM_ALLOC_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AllocationTracker::snapshot(AllocationSnapshot &out)
+{
+    std::memset(&out, 0, sizeof(out));
+#ifdef TRAFFICSIM_ALLOC_TRACKING
+    int blocks = g_blockCount.load(std::memory_order_relaxed);
+    for (int b = 0; b < blocks; ++b) {
+        accumulate(g_blocks[b], out);
+    }
+    out.liveBytes = g_liveBytes.load(std::memory_order_relaxed);
+    out.peakBytes = g_peakBytes.load(std::memory_order_relaxed);
+#endif
+}
+
+void AllocationTracker::snapshot(const int *blocks, std::size_t count, AllocationSnapshot &out)
+{
+    std::memset(&out, 0, sizeof(out));
+#ifdef TRAFFICSIM_ALLOC_TRACKING
+    for (std::size_t i = 0; i < count; ++i) {
+        // Threads sharing the overflow block would otherwise be counted twice
+        if (blocks[i] < 0 || blocks[i] >= kMaxThreads || std::find(blocks, blocks + i, blocks[i]) != blocks + i) {
+            continue;
+        }
+        accumulate(g_blocks[blocks[i]], out);
+    }
+    out.liveBytes = g_liveBytes.load(std::memory_order_relaxed);
+    out.peakBytes = g_peakBytes.load(std::memory_order_relaxed);
+#else
+    (void)blocks;
+    (void)count;
+#endif
+}
+
+int AllocationTracker::threadBlock()
+{
+#ifdef TRAFFICSIM_ALLOC_TRACKING
+    return static_cast<int>(&counters() - g_blocks);
+#else
+    return -1;
+#endif
+}
+
+void AllocationTracker::difference(const AllocationSnapshot &later, const AllocationSnapshot &earlier, AllocationSnapshot &out)
+{
+    for (int p = 0; p < kPhases; ++p) {
+        out.phases[p].allocations = later.phases[p].allocations - earlier.phases[p].allocations;
+        out.phases[p].allocatedBytes = later.phases[p].allocatedBytes - earlier.phases[p].allocatedBytes;
+        out.phases[p].frees = later.phases[p].frees - earlier.phases[p].frees;
+        out.phases[p].freedBytes = later.phases[p].freedBytes - earlier.phases[p].freedBytes;
+    }
+    out.liveBytes = later.liveBytes;
+    out.peakBytes = later.peakBytes;
+}
+
+void AllocationTracker::resetPeak()
+{
+#ifdef TRAFFICSIM_ALLOC_TRACKING
+    g_peakBytes.store(g_liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+#endif
+}
+
+const char *AllocationTracker::phaseName(AllocationPhase phase)
+{
+    int index = static_cast<int>(phase);
+    return (index >= 0 && index < kPhases) ? kPhaseNames[index] : "unknown";
+}
+
+AllocationPhase AllocationTracker::currentPhase()
+{
+    return t_phase;
+}
+
+AllocationPhase AllocationTracker::enterPhase(AllocationPhase phase)
+{
+    AllocationPhase previous = t_phase;
+    t_phase = phase;
+    return previous;
+}
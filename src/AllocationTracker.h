@@ -0,0 +1,180 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @enum AllocationPhase
+ * @brief The part of the simulation an allocation is charged to.
+ */
+enum class AllocationPhase {
+    Other, ///< Anything outside a tagged phase.
+    Spawn, ///< TrafficSim::spawnVehicles.
+    Update, ///< Intersection updates and vehicle hand-over.
+    Routing, ///< Route lookups and re-routing on the simulation thread.
+    Repair, ///< Background route tree repair.
+    Publish, ///< Building the per-step snapshot.
+    Statistics, ///< Statistics stage and steady-state detection.
+    Logging, ///< Logging stage.
+    Rendering, ///< Dashboard stage.
+    Count ///< Number of phases.
+};
+
+/**
+ * @struct AllocationStats
+ * @brief Allocation activity charged to one phase.
+ *
+ * Frees are charged to the phase that made the allocation, so allocatedBytes - freedBytes is the
+ * heap a phase still holds.
+ */
+struct AllocationStats {
+    std::uint64_t allocations; ///< Calls to operator new.
+    std::uint64_t allocatedBytes; ///< Bytes requested from operator new.
+    std::uint64_t frees; ///< Calls to operator delete.
+    std::uint64_t freedBytes; ///< Bytes returned through operator delete.
+};
+
+/**
+ * @struct AllocationSnapshot
+ * @brief Allocation counters of the process or of a set of threads at one point in time, or the
+ * difference of two.
+ */
+struct AllocationSnapshot {
+    AllocationStats phases[static_cast<int>(AllocationPhase::Count)]; ///< Counters per phase.
+    std::int64_t liveBytes; ///< Bytes currently allocated through operator new.
+    std::int64_t peakBytes; ///< Highest liveBytes since the last resetPeak().
+
+    /**
+     * @brief Sums the allocation calls over every phase.
+     */
+    std::uint64_t totalAllocations() const {
+        std::uint64_t total = 0;
+        for (const AllocationStats &stats : phases) {
+            total += stats.allocations;
+        }
+        return total;
+    }
+
+    /**
+     * @brief Sums the allocation calls of the phases run by the simulation thread itself (spawn,
+     * update, routing, publish). Unlike the background and pipeline phases, these always fall in
+     * the window of the step that made them.
+     */
+    std::uint64_t simulationAllocations() const {
+        return phases[static_cast<int>(AllocationPhase::Spawn)].allocations
+             + phases[static_cast<int>(AllocationPhase::Update)].allocations
+             + phases[static_cast<int>(AllocationPhase::Routing)].allocations
+             + phases[static_cast<int>(AllocationPhase::Publish)].allocations;
+    }
+
+    /**
+     * @brief Sums the allocated bytes over every phase.
+     */
+    std::uint64_t totalAllocatedBytes() const {
+        std::uint64_t total = 0;
+        for (const AllocationStats &stats : phases) {
+            total += stats.allocatedBytes;
+        }
+        return total;
+    }
+};
+
+/**
+ * @class AllocationTracker
+ * @brief Heap accounting through replaced global operator new and delete.
+ *
+ * Only active in builds configured with -DTRAFFICSIM_ALLOC_TRACKING=ON. The hooks put a small
+ * header in front of every block to remember its size and phase. Counters live in per-thread
+ * blocks leased from a static pool, so counting never allocates and threads do not share cache
+ * lines. A block goes back to the pool when its thread exits; while the pool is exhausted, new
+ * threads share one overflow block. Live and peak heap are kept in two process-wide atomics. Without the option every call
+ * here is a no-op and snapshots stay zero.
+ */
+class AllocationTracker {
+public:
+    /**
+     * @brief Checks whether the allocation hooks are compiled in.
+     */
+    static bool available();
+
+    /**
+     * @brief Sums every thread's counters.
+     *
+     * @param out Receives the current totals.
+     */
+    static void snapshot(AllocationSnapshot &out);
+
+    /**
+     * @brief Sums the counters of the given threads only; live and peak heap stay process-wide.
+     *
+     * @param blocks Counter blocks returned by threadBlock() on those threads; negative entries are ignored.
+     * @param count The number of entries in blocks.
+     * @param out Receives their totals.
+     */
+    static void snapshot(const int *blocks, std::size_t count, AllocationSnapshot &out);
+
+    /**
+     * @brief Gets the counter block of the calling thread, leasing one on first use.
+     *
+     * The index stays valid until the thread exits.
+     *
+     * @return The block index, -1 without the allocation hooks.
+     */
+    static int threadBlock();
+
+    /**
+     * @brief Computes the activity between two snapshots; live and peak are taken from the later one.
+     *
+     * @param later The later snapshot.
+     * @param earlier The earlier snapshot.
+     * @param out Receives the difference.
+     */
+    static void difference(const AllocationSnapshot &later, const AllocationSnapshot &earlier, AllocationSnapshot &out);
+
+    /**
+     * @brief Restarts peak tracking from the current live heap.
+     */
+    static void resetPeak();
+
+    /**
+     * @brief Gets the lower-case name of a phase.
+     */
+    static const char *phaseName(AllocationPhase phase);
+
+    /**
+     * @brief Gets the phase the calling thread charges allocations to.
+     */
+    static AllocationPhase currentPhase();
+
+    /**
+     * @brief Sets the phase the calling thread charges allocations to.
+     *
+     * @return The previous phase.
+     */
+    static AllocationPhase enterPhase(AllocationPhase phase);
+};
+
+/**
+ * @class AllocationScope
+ * @brief Charges the calling thread's allocations to a phase until the scope ends.
+ */
+class AllocationScope {
+public:
+    /**
+     * @brief Constructor for the AllocationScope class.
+     *
+     * @param phase The phase to charge.
+     */
+    explicit AllocationScope(AllocationPhase phase)
+        : m_previous(AllocationTracker::enterPhase(phase)) {}
+
+    /**
+     * @brief Destructor for the AllocationScope class. Restores the previous phase.
+     */
+    ~AllocationScope() { AllocationTracker::enterPhase(m_previous); }
+
+    AllocationScope(const AllocationScope &) = delete;
+    AllocationScope &operator=(const AllocationScope &) = delete;
+
+private:
+    AllocationPhase m_previous; ///< The phase active before the scope.
+};
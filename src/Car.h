@@ -16,7 +16,7 @@ public:
      * @param id The unique identifier for the car.
      * @param speed The speed of the car.
      */
-    Car(int id, double speed)
+    Car(std::uint64_t id, double speed)
         : LandVehicle(id, speed, 4) {
     }
 
@@ -25,6 +25,23 @@ public:
      */
     ~Car() override = default;
 
+    /**
+     * @brief Move constructor for the Car class.
+     * 
+     * Lets the vehicle registry keep cars by value in a dense array.
+     * 
+     * @param other The Car object to move from.
+     */
+    Car(Car&& other) noexcept = default;
+
+    /**
+     * @brief Move assignment operator for the Car class.
+     * 
+     * @param other The Car object to move from.
+     * @return A reference to the assigned Car object.
+     */
+    Car& operator=(Car&& other) noexcept = default;
+
     /**
      * @brief Updates the state of the car.
      * 
@@ -34,4 +51,14 @@ public:
         // Example: Just print that we're updating
         std::cout << "[Car] ID=" << m_id << " updating state.\n";
     }
+
+    /**
+     * @brief Gets the car-following parameters of the car.
+     * 
+     * @return The Intelligent Driver Model parameters of the car.
+     */
+    IdmParams getIdmParams() const override {
+        // v0 (m/s), T (s), a (m/s^2), b (m/s^2), s0 (m), length (m)
+        return IdmParams{ m_speed / 3.6, 1.2, 1.5, 2.0, 2.0, 4.5 };
+    }
 };
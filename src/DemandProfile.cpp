@@ -0,0 +1,212 @@
+#include "DemandProfile.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+// Trims leading and trailing whitespace
+static std::string trim(const std::string &text)
+{
+    const char *whitespace = " \t\r\n";
+    std::string::size_type first = text.find_first_not_of(whitespace);
+    if (first == std::string::npos) {
+        return "";
+    }
+    std::string::size_type last = text.find_last_not_of(whitespace);
+    return text.substr(first, last - first + 1);
+}
+
+// Maps a vehicle type name from the profile to its enum value
+static bool parseVehicleType(const std::string &name, VehicleType &type)
+{
+    if (name == "Car") {
+        type = VehicleType::Car;
+        return true;
+    }
+    if (name == "Truck") {
+        type = VehicleType::Truck;
+        return true;
+    }
+    return false;
+}
+
+// True once only whitespace is left in a value
+static bool atEnd(std::istringstream &value)
+{
+    value >> std::ws;
+    return value.eof();
+}
+
+// Hands the accumulated error message to the caller
+static bool fail(const std::ostringstream &err, std::string &error)
+{
+    error = err.str();
+    return false;
+}
+
+DemandProfile::DemandProfile()
+    : m_numIntersections(0),
+      m_activeWindow(-1)
+{
+}
+
+// ----------------------------------------------------------------
+//   load
+// ----------------------------------------------------------------
+bool DemandProfile::load(const std::string &path, int numIntersections, std::string &error)
+{
+    std::ostringstream err;
+    std::ifstream inFile(path);
+    if (!inFile.is_open()) {
+        err << "[Error] Could not open demand profile: " << path << "\n";
+        return fail(err, error);
+    }
+
+    m_windows.clear();
+    m_numIntersections = numIntersections;
+    m_activeWindow = -1;
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(inFile, line))
+    {
+        ++lineNumber;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+
+        std::string::size_type eq = line.find('=');
+        if (eq == std::string::npos) {
+            err << "[Error] " << path << ":" << lineNumber << ": expected 'key = value'.\n";
+            return fail(err, error);
+        }
+        std::string key = trim(line.substr(0, eq));
+        std::istringstream value(line.substr(eq + 1));
+
+        if (key == "window") {
+            Window window;
+            if (!(value >> window.startStep >> window.endStep) || !atEnd(value) || window.endStep < window.startStep) {
+                err << "[Error] " << path << ":" << lineNumber << ": window needs '<first> <last>' steps.\n";
+                return fail(err, error);
+            }
+            window.arrivalRate = 0.0;
+            window.defaultWeight = 1.0;
+            window.mix = { 1.0, 1.0 };
+            m_windows.push_back(window);
+            continue;
+        }
+
+        if (m_windows.empty()) {
+            err << "[Error] " << path << ":" << lineNumber << ": '" << key << "' before the first window.\n";
+            return fail(err, error);
+        }
+        Window &window = m_windows.back();
+
+        bool ok = true;
+        if (key == "arrival_rate") {
+            ok = static_cast<bool>(value >> window.arrivalRate) && window.arrivalRate >= 0.0 && atEnd(value);
+        }
+        else if (key == "default_weight") {
+            ok = static_cast<bool>(value >> window.defaultWeight) && window.defaultWeight >= 0.0 && atEnd(value);
+        }
+        else if (key == "weight") {
+            int id = 0;
+            double weight = 0.0;
+            ok = static_cast<bool>(value >> id >> weight)
+                && id >= 1 && id <= numIntersections && weight >= 0.0 && atEnd(value);
+            if (ok) {
+                window.weights.push_back({ id, weight });
+            }
+        }
+        else if (key == "mix") {
+            // Complete '<type> <share>' pairs only; an empty or all-zero mix cannot be sampled
+            std::fill(window.mix.begin(), window.mix.end(), 0.0);
+            std::string name;
+            while (ok && value >> name) {
+                VehicleType type;
+                double share = 0.0;
+                ok = parseVehicleType(name, type) && static_cast<bool>(value >> share) && share >= 0.0;
+                if (ok) {
+                    window.mix[static_cast<int>(type)] = share;
+                }
+            }
+            double total = 0.0;
+            for (double share : window.mix) {
+                total += share;
+            }
+            ok = ok && total > 0.0;
+        }
+        else {
+            err << "[Error] " << path << ":" << lineNumber << ": unknown key '" << key << "'.\n";
+            return fail(err, error);
+        }
+
+        if (!ok) {
+            err << "[Error] " << path << ":" << lineNumber << ": invalid value for '" << key << "'.\n";
+            return fail(err, error);
+        }
+    }
+
+    std::sort(m_windows.begin(), m_windows.end(),
+              [](const Window &a, const Window &b) { return a.startStep < b.startStep; });
+    for (std::size_t i = 1; i < m_windows.size(); ++i) {
+        if (m_windows[i].startStep <= m_windows[i - 1].endStep) {
+            err << "[Error] " << path << ": windows starting at steps "
+                      << m_windows[i - 1].startStep << " and " << m_windows[i].startStep << " overlap.\n";
+            return fail(err, error);
+        }
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------
+//   Window selection & lazy table rebuild
+// ----------------------------------------------------------------
+int DemandProfile::findWindow(int step) const
+{
+    // Steps only move forward, so the active window is almost always the answer
+    if (m_activeWindow >= 0) {
+        const Window &active = m_windows[m_activeWindow];
+        if (step >= active.startStep && step <= active.endStep) {
+            return m_activeWindow;
+        }
+    }
+
+    auto it = std::upper_bound(m_windows.begin(), m_windows.end(), step,
+                               [](int s, const Window &w) { return s < w.startStep; });
+    if (it == m_windows.begin()) {
+        return -1;
+    }
+    --it;
+    return (step <= it->endStep) ? static_cast<int>(it - m_windows.begin()) : -1;
+}
+
+bool DemandProfile::activate(int step)
+{
+    int window = findWindow(step);
+    if (window < 0) {
+        return false;
+    }
+    if (window != m_activeWindow) {
+        m_activeWindow = window;
+        rebuildTables();
+    }
+    return true;
+}
+
+void DemandProfile::rebuildTables()
+{
+    const Window &window = m_windows[m_activeWindow];
+
+    m_weightBuffer.assign(m_numIntersections, window.defaultWeight);
+    for (const auto &entry : window.weights) {
+        m_weightBuffer[entry.first - 1] = entry.second;
+    }
+    m_intersectionTable.build(m_weightBuffer);
+    m_typeTable.build(window.mix);
+}
+
+int DemandProfile::sampleArrivals(RandomGen &rng) const
+{
+    return rng.randomPoisson(m_windows[m_activeWindow].arrivalRate);
+}
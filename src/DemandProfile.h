@@ -0,0 +1,134 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+#include "AliasTable.h"
+#include "RandomGen.h"
+
+/**
+ * @enum VehicleType
+ * @brief The kinds of vehicles the simulation can spawn.
+ */
+enum class VehicleType {
+    Car,
+    Truck
+};
+
+/**
+ * @class DemandProfile
+ * @brief Time-varying, weighted traffic demand loaded from a profile file.
+ *
+ * A profile is a list of step windows. Each window defines a Poisson arrival rate, per-intersection
+ * weights (how likely a vehicle is to appear at an intersection) and a vehicle-type mix. Sampling uses
+ * alias tables, so every draw is O(1) regardless of the number of intersections. The tables are only
+ * rebuilt when the simulation enters a different window.
+ *
+ * Profile file format (one `key = value` per line, `#` starts a comment):
+ * @code
+ * window = 1 300          # first and last step covered by this window
+ * arrival_rate = 8.5      # mean number of vehicles spawned per step
+ * default_weight = 1.0    # weight of every intersection not listed below
+ * weight = 2 5.0          # intersection 2 is five times as busy
+ * mix = Car 0.7 Truck 0.3 # relative share of each vehicle type
+ * @endcode
+ */
+class DemandProfile {
+public:
+    /**
+     * @brief Constructor for the DemandProfile class. The profile starts empty.
+     */
+    DemandProfile();
+
+    /**
+     * @brief Loads the profile from the specified file.
+     *
+     * @param path The path to the profile file.
+     * @param numIntersections The number of intersections in the simulation (ids 1..numIntersections).
+     * @param error Receives a description of the problem if loading fails.
+     * @return True if the profile is loaded successfully, false otherwise.
+     */
+    bool load(const std::string &path, int numIntersections, std::string &error);
+
+    /**
+     * @brief Removes every window so no step is covered by the profile.
+     */
+    void clear() {
+        m_windows.clear();
+        m_activeWindow = -1;
+    }
+
+    /**
+     * @brief Checks whether the profile has any windows.
+     *
+     * @return True if no profile is loaded, false otherwise.
+     */
+    bool empty() const { return m_windows.empty(); }
+
+    /**
+     * @brief Selects the window covering the given step, rebuilding the alias tables if it changed.
+     *
+     * @param step The simulation step about to be spawned.
+     * @return True if a window covers the step, false otherwise.
+     */
+    bool activate(int step);
+
+    /**
+     * @brief Draws the number of vehicles arriving in the active window's step.
+     *
+     * @param rng The random number generator to draw from.
+     * @return The number of vehicles to spawn.
+     */
+    int sampleArrivals(RandomGen &rng) const;
+
+    /**
+     * @brief Draws the intersection a new vehicle appears at.
+     *
+     * @param rng The random number generator to draw from.
+     * @return The id of the chosen intersection.
+     */
+    int sampleIntersection(RandomGen &rng) const { return m_intersectionTable.sample(rng) + 1; }
+
+    /**
+     * @brief Draws the type of a new vehicle from the active window's mix.
+     *
+     * @param rng The random number generator to draw from.
+     * @return The chosen vehicle type.
+     */
+    VehicleType sampleVehicleType(RandomGen &rng) const {
+        return static_cast<VehicleType>(m_typeTable.sample(rng));
+    }
+
+private:
+    /**
+     * @struct Window
+     * @brief Demand parameters for a contiguous range of steps.
+     */
+    struct Window {
+        int startStep; ///< The first step covered by the window.
+        int endStep; ///< The last step covered by the window.
+        double arrivalRate; ///< The mean number of arrivals per step.
+        double defaultWeight; ///< The weight of intersections without an explicit weight.
+        std::vector<std::pair<int, double>> weights; ///< Explicit (intersection id, weight) overrides.
+        std::vector<double> mix; ///< Relative share of each VehicleType, indexed by the enum value.
+    };
+
+    /**
+     * @brief Finds the window covering the given step.
+     *
+     * @param step The simulation step.
+     * @return The index of the window, or -1 if no window covers the step.
+     */
+    int findWindow(int step) const;
+
+    /**
+     * @brief Rebuilds the alias tables for the active window.
+     */
+    void rebuildTables();
+
+    std::vector<Window> m_windows; ///< The windows of the profile, sorted by start step.
+    int m_numIntersections; ///< The number of intersections the profile was loaded for.
+    int m_activeWindow; ///< The index of the window the tables were built for, or -1.
+    AliasTable m_intersectionTable; ///< Samples intersection indices for the active window.
+    AliasTable m_typeTable; ///< Samples vehicle types for the active window.
+    std::vector<double> m_weightBuffer; ///< Reused buffer of dense intersection weights.
+};
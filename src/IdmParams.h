@@ -0,0 +1,18 @@
+#pragma once
+
+/**
+ * @struct IdmParams
+ * @brief Intelligent Driver Model parameters of a single vehicle.
+ *
+ * The acceleration of a vehicle following a leader at gap s with approach rate dv is
+ * a * (1 - (v / v0)^4 - (s* / s)^2), where s* = s0 + max(0, v * T + v * dv / (2 * sqrt(a * b))).
+ * All values are in SI units (m, s, m/s, m/s^2).
+ */
+struct IdmParams {
+    double desiredSpeed; ///< v0: speed the driver aims for on a free road.
+    double timeHeadway; ///< T: desired time gap to the leader.
+    double maxAcceleration; ///< a: maximum acceleration.
+    double comfortableDeceleration; ///< b: comfortable braking deceleration (positive).
+    double minimumGap; ///< s0: bumper-to-bumper gap kept when stopped.
+    double length; ///< Length of the vehicle.
+};
@@ -0,0 +1,151 @@
+#pragma once
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+/**
+ * @class IndexedHeap
+ * @brief Max-heap over the keys 0..n-1 whose priorities can be changed in place.
+ *
+ * Every key knows its position in the heap, so changing one priority costs O(log n) and the
+ * rest of the heap is left untouched. Ties are broken by the smaller key, which keeps rankings
+ * stable from frame to frame.
+ */
+class IndexedHeap {
+public:
+    /**
+     * @brief Resets the heap to hold the keys 0..size-1, all with priority 0.
+     *
+     * @param size The number of keys.
+     */
+    void reset(int size) {
+        m_priority.assign(size, 0);
+        m_heap.resize(size);
+        m_position.resize(size);
+        for (int key = 0; key < size; ++key) {
+            m_heap[key] = key;
+            m_position[key] = key;
+        }
+    }
+
+    /**
+     * @brief Changes the priority of a key and restores the heap order around it.
+     *
+     * @param key The key to update.
+     * @param priority The new priority.
+     */
+    void update(int key, int priority) {
+        int old = m_priority[key];
+        m_priority[key] = priority;
+        if (priority > old) {
+            siftUp(m_position[key]);
+        } else if (priority < old) {
+            siftDown(m_position[key]);
+        }
+    }
+
+    /**
+     * @brief Gets the current priority of a key.
+     *
+     * @param key The key to look up.
+     * @return The priority of the key.
+     */
+    int priority(int key) const { return m_priority[key]; }
+
+    /**
+     * @brief Gets the number of keys in the heap.
+     *
+     * @return The number of keys.
+     */
+    int size() const { return static_cast<int>(m_heap.size()); }
+
+    /**
+     * @brief Collects the k keys with the highest priority, highest first.
+     *
+     * Walks the heap with a small frontier heap instead of popping, so the cost is O(k log k)
+     * and the heap itself is not modified.
+     *
+     * @param k The number of keys to collect.
+     * @param out Receives the keys (cleared first).
+     */
+    void top(int k, std::vector<int> &out) {
+        out.clear();
+        m_frontier.clear();
+        if (m_heap.empty() || k <= 0) {
+            return;
+        }
+
+        // The frontier holds heap positions; its order mirrors the main heap's order
+        auto lower = [this](int a, int b) { return before(m_heap[b], m_heap[a]); };
+        m_frontier.push_back(0);
+        while (!m_frontier.empty() && static_cast<int>(out.size()) < k) {
+            std::pop_heap(m_frontier.begin(), m_frontier.end(), lower);
+            int pos = m_frontier.back();
+            m_frontier.pop_back();
+            out.push_back(m_heap[pos]);
+
+            for (int child = 2 * pos + 1; child <= 2 * pos + 2 && child < size(); ++child) {
+                m_frontier.push_back(child);
+                std::push_heap(m_frontier.begin(), m_frontier.end(), lower);
+            }
+        }
+    }
+
+private:
+    /**
+     * @brief Checks whether key a ranks above key b.
+     */
+    bool before(int a, int b) const {
+        return m_priority[a] > m_priority[b] || (m_priority[a] == m_priority[b] && a < b);
+    }
+
+    /**
+     * @brief Swaps two heap positions and keeps the position index in sync.
+     */
+    void swapAt(int i, int j) {
+        std::swap(m_heap[i], m_heap[j]);
+        m_position[m_heap[i]] = i;
+        m_position[m_heap[j]] = j;
+    }
+
+    /**
+     * @brief Moves the key at a heap position up until its parent ranks above it.
+     */
+    void siftUp(int pos) {
+        while (pos > 0) {
+            int parent = (pos - 1) / 2;
+            if (!before(m_heap[pos], m_heap[parent])) {
+                break;
+            }
+            swapAt(pos, parent);
+            pos = parent;
+        }
+    }
+
+    /**
+     * @brief Moves the key at a heap position down until it ranks above both children.
+     */
+    void siftDown(int pos) {
+        for (;;) {
+            int best = pos;
+            int left = 2 * pos + 1;
+            int right = left + 1;
+            if (left < size() && before(m_heap[left], m_heap[best])) {
+                best = left;
+            }
+            if (right < size() && before(m_heap[right], m_heap[best])) {
+                best = right;
+            }
+            if (best == pos) {
+                break;
+            }
+            swapAt(pos, best);
+            pos = best;
+        }
+    }
+
+    std::vector<int> m_priority; ///< The priority of each key.
+    std::vector<int> m_heap; ///< Keys in heap order.
+    std::vector<int> m_position; ///< Heap position of each key.
+    std::vector<int> m_frontier; ///< Scratch heap of positions used by top().
+};
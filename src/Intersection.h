@@ -1,13 +1,14 @@
 #pragma once
 #include <vector>
-#include <memory>
-#include "Vehicle.h"
+#include "Lane.h"
+#include "Span.h"
+#include "VehicleRegistry.h"
 
 /**
  * @class Intersection
  * @brief Represents a traffic intersection in the simulation.
  * 
- * The Intersection class manages the traffic light and the vehicles waiting at the intersection.
+ * The Intersection class manages the traffic light and the approach lane of vehicles driving towards it.
  */
 class Intersection {
 public:
@@ -21,9 +22,13 @@ public:
           m_lightGreenTime(3),
           m_lightRedTime(2),
           m_isGreen(true),
+          m_closed(false),
           m_elapsed(0),
           m_throughput(0),
-          m_passedThisStep(0) {}
+          m_passedThisStep(0),
+          m_changed(false),
+          m_stepSeconds(1.0),
+          m_subSteps(10) {}
 
     /**
      * @brief Sets the traffic light times for the intersection.
@@ -37,24 +42,57 @@ public:
     }
 
     /**
-     * @brief Adds a vehicle to the intersection's waiting queue.
+     * @brief Returns the intersection to its initial state so it can be reused for a new run.
      * 
-     * @param v A unique pointer to the vehicle to be added.
+     * The light restarts on green, all counters are zeroed and the approach lane is emptied
+     * without releasing its storage. The vehicles themselves are owned by the registry.
      */
-    void addVehicle(std::unique_ptr<Vehicle> v) {
-        m_vehicles.push_back(std::move(v));
+    void reset() {
+        m_isGreen = true;
+        m_closed = false;
+        m_elapsed = 0;
+        m_throughput = 0;
+        m_passedThisStep = 0;
+        m_changed = false;
+        m_lane.clear();
+        m_exited.clear();
+    }
+
+    /**
+     * @brief Sets the approach geometry and the car-following integration settings.
+     * 
+     * @param laneLength The distance from the lane entry to the stop line in metres.
+     * @param stepSeconds The duration of one simulation step in seconds.
+     * @param subSteps The number of kinematic sub-steps per simulation step.
+     */
+    void setKinematics(double laneLength, double stepSeconds, int subSteps) {
+        m_lane.setLength(laneLength);
+        m_stepSeconds = stepSeconds;
+        m_subSteps = subSteps;
+    }
+
+    /**
+     * @brief Adds a vehicle at the entry of the intersection's approach lane.
+     * 
+     * @param handle The registry handle of the vehicle to be added.
+     * @param vehicle The vehicle itself, providing its speed and car-following parameters.
+     */
+    void addVehicle(VehicleHandle handle, const Vehicle &vehicle) {
+        IdmParams params = vehicle.getIdmParams();
+        m_lane.enter(handle, params, params.desiredSpeed);
+        m_changed = true;
     }
 
     /**
      * @brief Updates the state of the intersection.
      * 
-     * This method updates the traffic light and processes the vehicles waiting at the intersection.
+     * This method updates the traffic light and drives the vehicles on the approach lane.
+     * Vehicles that cross the stop line are listed by getExited() until the next update; the
+     * caller decides whether they leave the network or drive on.
      */
     void update() {
-        // Reset how many passed in THIS step
-        m_passedThisStep = 0;
-
-        // Update traffic light
+        // Update traffic light (follows isGreenAfter; a toggle alone does not mark the intersection changed)
+        int passedBefore = m_passedThisStep;
         m_elapsed++;
         if (m_isGreen && m_elapsed >= m_lightGreenTime) {
             m_isGreen = false;
@@ -64,16 +102,45 @@ public:
             m_elapsed = 0;
         }
 
-        // If green, let's let all queued vehicles pass this step
-        if (m_isGreen && !m_vehicles.empty())
-        {
-            int passed = static_cast<int>(m_vehicles.size());
-            m_throughput += passed;
-            m_passedThisStep = passed;
-            m_vehicles.clear();
-        }
+        // Car-following on the approach; the stop line only opens on green and never while closed
+        m_exited.clear();
+        m_lane.advance(m_stepSeconds, m_subSteps, m_isGreen && !m_closed, m_exited);
+
+        m_passedThisStep = static_cast<int>(m_exited.size());
+        m_throughput += m_passedThisStep;
+        m_changed = m_changed || m_passedThisStep > 0 || m_passedThisStep != passedBefore;
+    }
+
+    /**
+     * @brief Closes or reopens the intersection. A closed stop line stays shut whatever the light shows.
+     * 
+     * @param closed True to close the intersection.
+     */
+    void setClosed(bool closed) { m_closed = closed; }
+
+    /**
+     * @brief Checks if the intersection is closed.
+     * 
+     * @return True if the intersection is closed, false otherwise.
+     */
+    bool isClosed() const { return m_closed; }
+
+    /**
+     * @brief Gets the vehicles that crossed the stop line in the last update.
+     * 
+     * @return A span of handles, valid until the next update.
+     */
+    Span<const VehicleHandle> getExited() const {
+        return Span<const VehicleHandle>(m_exited.data(), m_exited.size());
     }
 
+    /**
+     * @brief Gets the vehicles on the approach lane, front vehicle first.
+     * 
+     * @return A span of the queued vehicles' handles, valid until the lane next changes.
+     */
+    Span<const VehicleHandle> getQueuedVehicles() const { return m_lane.getHandles(); }
+
     /**
      * @brief Gets the unique identifier of the intersection.
      * 
@@ -88,12 +155,25 @@ public:
      */
     bool isGreen() const { return m_isGreen; }
 
+    /**
+     * @brief Computes the light state of an intersection that started on green after a number of updates.
+     * 
+     * Every light runs the same schedule, so consumers that only see changed intersections derive
+     * the light from the step number instead of publishing every toggle.
+     * 
+     * @param green The duration of the green light (at least 1).
+     * @param red The duration of the red light (at least 1).
+     * @param updates The number of update() calls since reset().
+     * @return True if the light is green after that many updates.
+     */
+    static bool isGreenAfter(int green, int red, int updates) { return updates % (green + red) < green; }
+
     /**
      * @brief Gets the number of vehicles waiting at the intersection.
      * 
-     * @return The number of vehicles waiting at the intersection.
+     * @return The number of vehicles on the approach lane that have not crossed the stop line yet.
      */
-    int getWaitingCount() const { return static_cast<int>(m_vehicles.size()); }
+    int getWaitingCount() const { return m_lane.size(); }
 
     /**
      * @brief Gets the total number of vehicles that have passed through the intersection.
@@ -109,14 +189,34 @@ public:
      */
     int getPassedThisStep() const { return m_passedThisStep; }
 
+    /**
+     * @brief Checks whether the waiting count, passed count or throughput changed since the last clearChanged().
+     * 
+     * Light toggles are not counted; see isGreenAfter().
+     * 
+     * @return True if any published state changed, false otherwise.
+     */
+    bool hasChanged() const { return m_changed; }
+
+    /**
+     * @brief Resets the change flag once the current counters have been published.
+     */
+    void clearChanged() { m_changed = false; }
+
 private:
     int m_id; ///< The unique identifier of the intersection.
     int m_lightGreenTime; ///< The duration of the green light.
     int m_lightRedTime; ///< The duration of the red light.
     bool m_isGreen; ///< Indicates if the traffic light is green.
+    bool m_closed; ///< Set while an incident closes the intersection.
     int m_elapsed; ///< The elapsed time since the last light change.
     int m_throughput; ///< The total number of vehicles that have passed through the intersection.
     int m_passedThisStep; ///< The number of vehicles that passed through the intersection in the current step.
+    bool m_changed; ///< Set when any published state changed since the last publish.
+
+    double m_stepSeconds; ///< The duration of one simulation step in seconds.
+    int m_subSteps; ///< The number of kinematic sub-steps per simulation step.
 
-    std::vector<std::unique_ptr<Vehicle>> m_vehicles; ///< The queue of vehicles waiting at the intersection.
+    Lane m_lane; ///< The approach lane of vehicles driving towards the stop line.
+    std::vector<VehicleHandle> m_exited; ///< Scratch list of vehicles that crossed the stop line this step.
 };
@@ -16,7 +16,7 @@ public:
      * @param speed The speed of the land vehicle.
      * @param wheels The number of wheels of the land vehicle.
      */
-    LandVehicle(int id, double speed, int wheels)
+    LandVehicle(std::uint64_t id, double speed, int wheels)
         : Vehicle(id, speed), m_numWheels(wheels) {}
 
     /**
@@ -24,6 +24,21 @@ public:
      */
     virtual ~LandVehicle() = default;
 
+    /**
+     * @brief Move constructor for the LandVehicle class.
+     * 
+     * @param other The LandVehicle object to move from.
+     */
+    LandVehicle(LandVehicle&& other) noexcept = default;
+
+    /**
+     * @brief Move assignment operator for the LandVehicle class.
+     * 
+     * @param other The LandVehicle object to move from.
+     * @return A reference to the assigned LandVehicle object.
+     */
+    LandVehicle& operator=(LandVehicle&& other) noexcept = default;
+
     /**
      * @brief Gets the number of wheels of the land vehicle.
      * 
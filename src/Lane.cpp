@@ -0,0 +1,209 @@
+#include "Lane.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+// ----------------------------------------------------------------
+//   SIMD helpers: one code path, 4 lanes with AVX, 2 with SSE2
+// ----------------------------------------------------------------
+namespace {
+
+#if defined(__AVX__)
+typedef __m256d vdouble;
+const int kSimdWidth = 4;
+inline vdouble vload(const double *p) { return _mm256_loadu_pd(p); }
+inline void vstore(double *p, vdouble v) { _mm256_storeu_pd(p, v); }
+inline vdouble vset(double x) { return _mm256_set1_pd(x); }
+inline vdouble vadd(vdouble a, vdouble b) { return _mm256_add_pd(a, b); }
+inline vdouble vsub(vdouble a, vdouble b) { return _mm256_sub_pd(a, b); }
+inline vdouble vmul(vdouble a, vdouble b) { return _mm256_mul_pd(a, b); }
+inline vdouble vdiv(vdouble a, vdouble b) { return _mm256_div_pd(a, b); }
+inline vdouble vmax(vdouble a, vdouble b) { return _mm256_max_pd(a, b); }
+#elif defined(__SSE2__) || defined(_M_X64)
+typedef __m128d vdouble;
+const int kSimdWidth = 2;
+inline vdouble vload(const double *p) { return _mm_loadu_pd(p); }
+inline void vstore(double *p, vdouble v) { _mm_storeu_pd(p, v); }
+inline vdouble vset(double x) { return _mm_set1_pd(x); }
+inline vdouble vadd(vdouble a, vdouble b) { return _mm_add_pd(a, b); }
+inline vdouble vsub(vdouble a, vdouble b) { return _mm_sub_pd(a, b); }
+inline vdouble vmul(vdouble a, vdouble b) { return _mm_mul_pd(a, b); }
+inline vdouble vdiv(vdouble a, vdouble b) { return _mm_div_pd(a, b); }
+inline vdouble vmax(vdouble a, vdouble b) { return _mm_max_pd(a, b); }
+#else
+const int kSimdWidth = 1;
+#endif
+
+const double kFreeRoadGap = 1.0e6; ///< Gap used for a leader that does not exist.
+const double kMinGap = 0.01;       ///< Keeps (s* / s)^2 finite when bumpers touch.
+
+// IDM acceleration of one vehicle (scalar reference for the SIMD kernel and its tail)
+inline double idmAcceleration(double v, double gap, double dv, double v0, double T,
+                              double a, double brakingTerm, double s0)
+{
+    double sStar = s0 + std::max(0.0, v * T + v * dv / brakingTerm);
+    double ratio = v / v0;
+    double ratio2 = ratio * ratio;
+    double gapRatio = sStar / gap;
+    return a * (1.0 - ratio2 * ratio2 - gapRatio * gapRatio);
+}
+
+// Computes the IDM acceleration of n vehicles from contiguous arrays
+void accelerationKernel(int n, const double *v, const double *gap, const double *dv,
+                        const double *v0, const double *T, const double *a,
+                        const double *brakingTerm, const double *s0, double *acc)
+{
+    int i = 0;
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+    const vdouble zero = vset(0.0);
+    const vdouble one = vset(1.0);
+    for (; i + kSimdWidth <= n; i += kSimdWidth) {
+        vdouble vv = vload(v + i);
+        vdouble dynamic = vadd(vmul(vv, vload(T + i)), vdiv(vmul(vv, vload(dv + i)), vload(brakingTerm + i)));
+        vdouble sStar = vadd(vload(s0 + i), vmax(zero, dynamic));
+        vdouble ratio = vdiv(vv, vload(v0 + i));
+        vdouble ratio2 = vmul(ratio, ratio);
+        vdouble gapRatio = vdiv(sStar, vload(gap + i));
+        vdouble free = vmul(ratio2, ratio2);
+        vdouble interaction = vmul(gapRatio, gapRatio);
+        vstore(acc + i, vmul(vload(a + i), vsub(vsub(one, free), interaction)));
+    }
+#endif
+    for (; i < n; ++i) {
+        acc[i] = idmAcceleration(v[i], gap[i], dv[i], v0[i], T[i], a[i], brakingTerm[i], s0[i]);
+    }
+}
+
+// Integrates positions and speeds of n vehicles over dt; speeds never go negative
+void integrationKernel(int n, double dt, const double *acc, double *v, double *x)
+{
+    int i = 0;
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+    const vdouble zero = vset(0.0);
+    const vdouble vdt = vset(dt);
+    const vdouble halfDt = vset(0.5 * dt);
+    for (; i + kSimdWidth <= n; i += kSimdWidth) {
+        vdouble vOld = vload(v + i);
+        vdouble vNew = vmax(zero, vadd(vOld, vmul(vload(acc + i), vdt)));
+        vstore(x + i, vadd(vload(x + i), vmul(vadd(vOld, vNew), halfDt)));
+        vstore(v + i, vNew);
+    }
+#endif
+    for (; i < n; ++i) {
+        double vNew = std::max(0.0, v[i] + acc[i] * dt);
+        x[i] += (v[i] + vNew) * 0.5 * dt;
+        v[i] = vNew;
+    }
+}
+
+} // namespace
+
+// ----------------------------------------------------------------
+//   Lane
+// ----------------------------------------------------------------
+void Lane::enter(VehicleHandle handle, const IdmParams &params, double speed)
+{
+    double position = 0.0;
+    if (size() > 0) {
+        // With at least s*(v) of free road ahead the vehicle enters unhindered. Closer than that it
+        // matches the last vehicle's speed and keeps that follower's equilibrium gap, queueing
+        // upstream of the entry if needed, so the first sub-step is not an emergency stop
+        std::size_t last = m_handles.size() - 1;
+        double gap = m_position[last] - m_vehicleLength[last];
+        if (gap < params.minimumGap + speed * params.timeHeadway) {
+            speed = std::min(speed, m_velocity[last]);
+            position = std::min(0.0, gap - params.minimumGap - speed * params.timeHeadway);
+        }
+    }
+
+    m_handles.push_back(handle);
+    m_position.push_back(position);
+    m_velocity.push_back(speed);
+    m_acceleration.push_back(0.0);
+    m_desiredSpeed.push_back(params.desiredSpeed);
+    m_timeHeadway.push_back(params.timeHeadway);
+    m_maxAcceleration.push_back(params.maxAcceleration);
+    m_brakingTerm.push_back(2.0 * std::sqrt(params.maxAcceleration * params.comfortableDeceleration));
+    m_minimumGap.push_back(params.minimumGap);
+    m_vehicleLength.push_back(params.length);
+    m_gap.push_back(0.0);
+    m_approachRate.push_back(0.0);
+}
+
+void Lane::advance(double stepSeconds, int subSteps, bool stopLineOpen, std::vector<VehicleHandle> &exited)
+{
+    if (size() == 0 || subSteps <= 0) {
+        return;
+    }
+    const double dt = stepSeconds / subSteps;
+
+    for (int sub = 0; sub < subSteps && size() > 0; ++sub) {
+        const int n = size();
+        const std::size_t h = m_head;
+        double *position = m_position.data() + h;
+        double *velocity = m_velocity.data() + h;
+        double *gap = m_gap.data() + h;
+        double *approachRate = m_approachRate.data() + h;
+        const double *vehicleLength = m_vehicleLength.data() + h;
+
+        // Leader gaps are a serial dependency; everything after this loop is data-parallel
+        if (stopLineOpen) {
+            gap[0] = kFreeRoadGap;
+            approachRate[0] = 0.0;
+        } else {
+            gap[0] = std::max(kMinGap, m_length - position[0]);
+            approachRate[0] = velocity[0];
+        }
+        for (int i = 1; i < n; ++i) {
+            gap[i] = std::max(kMinGap, position[i - 1] - vehicleLength[i - 1] - position[i]);
+            approachRate[i] = velocity[i] - velocity[i - 1];
+        }
+
+        accelerationKernel(n, velocity, gap, approachRate,
+                           m_desiredSpeed.data() + h, m_timeHeadway.data() + h, m_maxAcceleration.data() + h,
+                           m_brakingTerm.data() + h, m_minimumGap.data() + h, m_acceleration.data() + h);
+        integrationKernel(n, dt, m_acceleration.data() + h, velocity, position);
+
+        if (stopLineOpen) {
+            int crossed = 0;
+            while (crossed < n && position[crossed] >= m_length) {
+                exited.push_back(m_handles[h + crossed]);
+                ++crossed;
+            }
+            m_head += crossed;
+        } else if (position[0] > m_length) {
+            // Red light: the stop line is a hard wall
+            position[0] = m_length;
+            velocity[0] = 0.0;
+        }
+    }
+
+    // Compacting only when the crossed prefix dominates keeps removal amortized O(1) per vehicle
+    if (m_head > 0 && 2 * m_head >= m_handles.size()) {
+        compact();
+    }
+}
+
+void Lane::clear()
+{
+    m_head = m_handles.size();
+    compact();
+}
+
+void Lane::compact()
+{
+    if (m_head == 0) {
+        return;
+    }
+    const std::ptrdiff_t count = static_cast<std::ptrdiff_t>(m_head);
+    m_handles.erase(m_handles.begin(), m_handles.begin() + count);
+    for (std::vector<double> *column : { &m_position, &m_velocity, &m_acceleration, &m_desiredSpeed,
+                                         &m_timeHeadway, &m_maxAcceleration, &m_brakingTerm,
+                                         &m_minimumGap, &m_vehicleLength, &m_gap, &m_approachRate }) {
+        column->erase(column->begin(), column->begin() + count);
+    }
+    m_head = 0;
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <vector>
+#include "IdmParams.h"
+#include "Span.h"
+#include "VehicleRegistry.h"
+
+/**
+ * @class Lane
+ * @brief A single approach lane leading to an intersection's stop line.
+ *
+ * Vehicles on the lane have continuous positions (metres from the lane entry) and follow the
+ * Intelligent Driver Model. State is stored as structure-of-arrays, front vehicle first, so the
+ * acceleration and integration kernels run over contiguous arrays with SIMD instructions.
+ * Vehicles crossing the stop line only advance a head offset; the arrays are compacted once the
+ * crossed prefix makes up half of them.
+ */
+class Lane {
+public:
+    /**
+     * @brief Constructor for the Lane class.
+     *
+     * @param length The distance from the lane entry to the stop line in metres.
+     */
+    explicit Lane(double length = 200.0)
+        : m_length(length), m_head(0) {}
+
+    /**
+     * @brief Sets the distance from the lane entry to the stop line.
+     *
+     * @param length The lane length in metres.
+     */
+    void setLength(double length) { m_length = length; }
+
+    /**
+     * @brief Gets the distance from the lane entry to the stop line.
+     *
+     * @return The lane length in metres.
+     */
+    double getLength() const { return m_length; }
+
+    /**
+     * @brief Adds a vehicle at the lane entry, behind the last vehicle already on the lane.
+     *
+     * If the last vehicle on the lane is at least the IDM desired gap s*(v) = s0 + v T ahead of the
+     * entry, the vehicle enters at the given speed. Otherwise it takes the last vehicle's speed if
+     * that is lower, and enters s*(v) behind it; if the entry is blocked it queues upstream of it
+     * (at a negative position).
+     *
+     * @param handle The registry handle of the vehicle.
+     * @param params The car-following parameters of the vehicle.
+     * @param speed The entry speed in m/s.
+     */
+    void enter(VehicleHandle handle, const IdmParams &params, double speed);
+
+    /**
+     * @brief Advances every vehicle on the lane by one simulation step.
+     *
+     * @param stepSeconds The duration of the simulation step in seconds.
+     * @param subSteps The number of integration sub-steps the step is split into.
+     * @param stopLineOpen True if vehicles may cross the stop line (green light).
+     * @param exited Receives the handles of vehicles that crossed the stop line, front first.
+     */
+    void advance(double stepSeconds, int subSteps, bool stopLineOpen, std::vector<VehicleHandle> &exited);
+
+    /**
+     * @brief Removes every vehicle from the lane, keeping the allocated storage.
+     */
+    void clear();
+
+    /**
+     * @brief Gets the number of vehicles on the lane.
+     *
+     * @return The number of vehicles that have not yet crossed the stop line.
+     */
+    int size() const { return static_cast<int>(m_handles.size() - m_head); }
+
+    /**
+     * @brief Gets the handles of the vehicles on the lane, front vehicle first.
+     *
+     * @return The vehicle handles in lane order, valid until the lane next changes.
+     */
+    Span<const VehicleHandle> getHandles() const {
+        return Span<const VehicleHandle>(m_handles.data() + m_head, m_handles.size() - m_head);
+    }
+
+private:
+    /**
+     * @brief Drops the vehicles before the head offset from every array.
+     */
+    void compact();
+
+    double m_length; ///< The distance from the lane entry to the stop line.
+    std::size_t m_head; ///< Index of the front vehicle; entries before it already crossed the stop line.
+
+    std::vector<VehicleHandle> m_handles; ///< The vehicles on the lane, front first.
+    std::vector<double> m_position; ///< Front-bumper position of each vehicle.
+    std::vector<double> m_velocity; ///< Speed of each vehicle.
+    std::vector<double> m_acceleration; ///< Acceleration computed in the last sub-step.
+
+    std::vector<double> m_desiredSpeed; ///< IDM v0 of each vehicle.
+    std::vector<double> m_timeHeadway; ///< IDM T of each vehicle.
+    std::vector<double> m_maxAcceleration; ///< IDM a of each vehicle.
+    std::vector<double> m_brakingTerm; ///< Precomputed 2 * sqrt(a * b) of each vehicle.
+    std::vector<double> m_minimumGap; ///< IDM s0 of each vehicle.
+    std::vector<double> m_vehicleLength; ///< Length of each vehicle.
+
+    std::vector<double> m_gap; ///< Scratch: net distance to the leader or the stop line.
+    std::vector<double> m_approachRate; ///< Scratch: speed difference to the leader.
+};
@@ -0,0 +1,160 @@
+#pragma once
+#include <fstream>
+#include <ostream>
+#include <string>
+
+/**
+ * @enum OutputChannel
+ * @brief The kinds of output the simulation produces.
+ */
+enum class OutputChannel {
+    Console, ///< The live dashboard and progress messages.
+    Log, ///< The step-by-step simulation log.
+    Error ///< Configuration and I/O errors.
+};
+
+/**
+ * @class OutputSink
+ * @brief Abstract destination for simulation output.
+ *
+ * Embedders implement this interface to capture output in their own process. A sink reports
+ * whether it is enabled so the simulation can skip formatting output nobody will read.
+ */
+class OutputSink {
+public:
+    /**
+     * @brief Virtual destructor for the OutputSink class.
+     */
+    virtual ~OutputSink() = default;
+
+    /**
+     * @brief Writes a chunk of text to the sink.
+     *
+     * @param text The text to write.
+     */
+    virtual void write(const std::string &text) = 0;
+
+    /**
+     * @brief Checks whether output sent to the sink is used at all.
+     *
+     * @return True if the sink consumes output, false if it discards it.
+     */
+    virtual bool enabled() const { return true; }
+};
+
+/**
+ * @class NullSink
+ * @brief Sink that discards everything. The default for every channel.
+ */
+class NullSink : public OutputSink {
+public:
+    /**
+     * @brief Discards the text.
+     *
+     * @param text The ignored text.
+     */
+    void write(const std::string &text) override { (void)text; }
+
+    /**
+     * @brief Reports that output is discarded.
+     *
+     * @return Always false.
+     */
+    bool enabled() const override { return false; }
+};
+
+/**
+ * @class StreamSink
+ * @brief Sink forwarding to an existing std::ostream such as std::cout.
+ */
+class StreamSink : public OutputSink {
+public:
+    /**
+     * @brief Constructor for the StreamSink class.
+     *
+     * @param stream The stream to write to; it must outlive the sink.
+     */
+    explicit StreamSink(std::ostream &stream)
+        : m_stream(stream) {}
+
+    /**
+     * @brief Writes the text to the stream and flushes it.
+     *
+     * @param text The text to write.
+     */
+    void write(const std::string &text) override {
+        m_stream << text;
+        m_stream.flush();
+    }
+
+private:
+    std::ostream &m_stream; ///< The wrapped stream.
+};
+
+/**
+ * @class FileSink
+ * @brief Sink writing to a file it owns.
+ */
+class FileSink : public OutputSink {
+public:
+    /**
+     * @brief Constructor for the FileSink class. Truncates the file.
+     *
+     * @param path The path of the file to write.
+     */
+    explicit FileSink(const std::string &path)
+        : m_file(path, std::ios::out) {}
+
+    /**
+     * @brief Checks whether the file could be opened.
+     *
+     * @return True if the file is open, false otherwise.
+     */
+    bool isOpen() const { return m_file.is_open(); }
+
+    /**
+     * @brief Appends the text to the file.
+     *
+     * @param text The text to write.
+     */
+    void write(const std::string &text) override { m_file << text; }
+
+    /**
+     * @brief Reports whether the file is open.
+     *
+     * @return True if output reaches the file, false otherwise.
+     */
+    bool enabled() const override { return m_file.is_open(); }
+
+private:
+    std::ofstream m_file; ///< The output file.
+};
+
+/**
+ * @class StringSink
+ * @brief Sink collecting output in memory, e.g. to return error messages to a client.
+ */
+class StringSink : public OutputSink {
+public:
+    /**
+     * @brief Appends the text to the buffer.
+     *
+     * @param text The text to write.
+     */
+    void write(const std::string &text) override { m_text += text; }
+
+    /**
+     * @brief Gets everything written since the last clear().
+     *
+     * @return The collected text.
+     */
+    const std::string &text() const { return m_text; }
+
+    /**
+     * @brief Empties the buffer, keeping its capacity.
+     */
+    void clear() { m_text.clear(); }
+
+private:
+    std::string m_text; ///< The collected output.
+};
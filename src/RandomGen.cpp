@@ -21,6 +21,15 @@ RandomGen::RandomGen()
     m_engine.seed(static_cast<unsigned long>(seed));
 }
 
+/**
+ * @brief Reseeds the generator so a run can be reproduced.
+ * 
+ * @param seed The new seed.
+ */
+void RandomGen::seed(unsigned long seed) {
+    m_engine.seed(seed);
+}
+
 /**
  * @brief Generates a random integer within the specified range.
  * 
@@ -44,3 +53,17 @@ double RandomGen::randomDouble(double minVal, double maxVal) {
     std::uniform_real_distribution<double> dist(minVal, maxVal);
     return dist(m_engine);
 }
+
+/**
+ * @brief Draws a count from a Poisson distribution.
+ * 
+ * @param mean The expected value of the distribution (values <= 0 always yield 0).
+ * @return A non-negative random integer.
+ */
+int RandomGen::randomPoisson(double mean) {
+    if (mean <= 0.0) {
+        return 0;
+    }
+    std::poisson_distribution<int> dist(mean);
+    return dist(m_engine);
+}
@@ -23,6 +23,13 @@ public:
      */
     ~RandomGen() = default;
 
+    /**
+     * @brief Reseeds the generator so a run can be reproduced.
+     * 
+     * @param seed The new seed.
+     */
+    void seed(unsigned long seed);
+
     /**
      * @brief Generates a random integer within the specified range.
      * 
@@ -41,6 +48,14 @@ public:
      */
     double randomDouble(double minVal, double maxVal);
 
+    /**
+     * @brief Draws a count from a Poisson distribution.
+     * 
+     * @param mean The expected value of the distribution (values <= 0 always yield 0).
+     * @return A non-negative random integer.
+     */
+    int randomPoisson(double mean);
+
 private:
     std::mt19937 m_engine; ///< Mersenne Twister random number engine.
 };
@@ -0,0 +1,134 @@
+#pragma once
+#include <cmath>
+#include <vector>
+#include "Span.h"
+
+/**
+ * @struct RoadLink
+ * @brief A directed road from one intersection to a neighbouring one.
+ */
+struct RoadLink {
+    int from; ///< Index of the upstream intersection.
+    int to; ///< Index of the downstream intersection.
+    double freeFlowSeconds; ///< Travel time on an empty road.
+};
+
+/**
+ * @class RoadNetwork
+ * @brief Directed graph connecting the intersections of the simulation.
+ *
+ * Nodes are intersection indices (id - 1). Links are stored once and indexed from both ends
+ * (compressed adjacency lists), so routing can walk outgoing and incoming links without
+ * allocating.
+ */
+class RoadNetwork {
+public:
+    /**
+     * @brief Lays the intersections out on a square grid, row by row, linking 4-neighbours both ways.
+     *
+     * @param numNodes The number of intersections.
+     * @param linkSeconds The free-flow travel time of every link.
+     */
+    void buildGrid(int numNodes, double linkSeconds) {
+        m_numNodes = numNodes;
+        m_links.clear();
+        int width = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(numNodes))));
+        for (int node = 0; node < numNodes; ++node) {
+            int right = node + 1;
+            int down = node + width;
+            if (right < numNodes && right % width != 0) {
+                m_links.push_back(RoadLink{ node, right, linkSeconds });
+                m_links.push_back(RoadLink{ right, node, linkSeconds });
+            }
+            if (down < numNodes) {
+                m_links.push_back(RoadLink{ node, down, linkSeconds });
+                m_links.push_back(RoadLink{ down, node, linkSeconds });
+            }
+        }
+        index(m_outOffsets, m_outLinks, true);
+        index(m_inOffsets, m_inLinks, false);
+    }
+
+    /**
+     * @brief Gets the number of intersections in the network.
+     */
+    int nodeCount() const { return m_numNodes; }
+
+    /**
+     * @brief Gets the number of directed links in the network.
+     */
+    int linkCount() const { return static_cast<int>(m_links.size()); }
+
+    /**
+     * @brief Gets a link by index.
+     *
+     * @param link The link index.
+     * @return The link.
+     */
+    const RoadLink &link(int link) const { return m_links[link]; }
+
+    /**
+     * @brief Gets the indices of the links leaving a node.
+     *
+     * @param node The intersection index.
+     * @return A span of link indices.
+     */
+    Span<const int> outgoing(int node) const {
+        return Span<const int>(m_outLinks.data() + m_outOffsets[node], m_outOffsets[node + 1] - m_outOffsets[node]);
+    }
+
+    /**
+     * @brief Gets the indices of the links entering a node.
+     *
+     * @param node The intersection index.
+     * @return A span of link indices.
+     */
+    Span<const int> incoming(int node) const {
+        return Span<const int>(m_inLinks.data() + m_inOffsets[node], m_inOffsets[node + 1] - m_inOffsets[node]);
+    }
+
+    /**
+     * @brief Looks up the link between two intersections.
+     *
+     * @param from The upstream intersection index.
+     * @param to The downstream intersection index.
+     * @return The link index, or -1 if the intersections are not adjacent.
+     */
+    int findLink(int from, int to) const {
+        if (from < 0 || from >= m_numNodes) {
+            return -1;
+        }
+        for (int link : outgoing(from)) {
+            if (m_links[link].to == to) {
+                return link;
+            }
+        }
+        return -1;
+    }
+
+private:
+    /**
+     * @brief Builds a compressed adjacency index keyed by either end of the links.
+     */
+    void index(std::vector<int> &offsets, std::vector<int> &links, bool byFrom) {
+        offsets.assign(m_numNodes + 1, 0);
+        for (const RoadLink &l : m_links) {
+            offsets[(byFrom ? l.from : l.to) + 1]++;
+        }
+        for (int node = 0; node < m_numNodes; ++node) {
+            offsets[node + 1] += offsets[node];
+        }
+        links.resize(m_links.size());
+        std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+        for (int i = 0; i < linkCount(); ++i) {
+            links[fill[byFrom ? m_links[i].from : m_links[i].to]++] = i;
+        }
+    }
+
+    int m_numNodes = 0; ///< The number of intersections.
+    std::vector<RoadLink> m_links; ///< Every directed link.
+    std::vector<int> m_outOffsets; ///< Start of each node's outgoing links in m_outLinks.
+    std::vector<int> m_outLinks; ///< Link indices grouped by upstream node.
+    std::vector<int> m_inOffsets; ///< Start of each node's incoming links in m_inLinks.
+    std::vector<int> m_inLinks; ///< Link indices grouped by downstream node.
+};
@@ -0,0 +1,380 @@
+#include "Router.h"
+#include "AllocationTracker.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+namespace {
+
+const double kUnreachable = std::numeric_limits<double>::infinity(); ///< Cost of a closed link.
+const double kEpsilon = 1e-9; ///< Cost differences below this are treated as ties.
+const int kNotSaved = -2; ///< Marks a node whose next hop was not saved during a repair.
+
+// Min-heap order for (cost, node) pairs
+const std::greater<std::pair<double, int>> kCheaper;
+
+} // namespace
+
+// ----------------------------------------------------------------
+//   Router Constructor/Destructor
+// ----------------------------------------------------------------
+Router::Router()
+    : m_network(nullptr),
+      m_cachedTrees(0),
+      m_generation(0),
+      m_running(0),
+      m_stopping(false)
+{
+}
+
+Router::~Router()
+{
+    stop();
+}
+
+// ----------------------------------------------------------------
+//   Lifecycle
+// ----------------------------------------------------------------
+void Router::reset(const RoadNetwork *network, int threads)
+{
+    stop();
+
+    m_network = network;
+    int nodes = network->nodeCount();
+    int links = network->linkCount();
+
+    m_nodeDelay.assign(nodes, 0.0);
+    m_nodeClosed.assign(nodes, 0);
+    m_linkClosed.assign(links, 0);
+    m_weights.resize(links);
+    for (int link = 0; link < links; ++link) {
+        m_weights[link] = network->link(link).freeFlowSeconds;
+    }
+    m_dirty.assign(links, 0);
+    m_dirtyLinks.clear();
+    m_published.assign(nodes, nullptr);
+    m_adopted.clear();
+    m_scratch.affected.assign(nodes, 0);
+    m_scratch.saved.assign(nodes, kNotSaved);
+    m_cachedTrees = 0;
+
+    m_batchWeights = m_weights;
+    m_trees.clear();
+    m_trees.resize(nodes);
+    m_treeDests.clear();
+    m_batchLinks.clear();
+    m_results.assign(threads > 0 ? threads : 1, std::vector<Result>());
+
+    m_generation = 0;
+    m_running = 0;
+    m_stopping = false;
+    for (std::size_t i = 0; i < m_results.size(); ++i) {
+        m_workers.emplace_back(&Router::workerLoop, this, static_cast<int>(i));
+    }
+}
+
+void Router::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_batchReady.notify_all();
+    for (std::thread &worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+// ----------------------------------------------------------------
+//   Link costs
+// ----------------------------------------------------------------
+double Router::linkWeight(int link) const
+{
+    const RoadLink &l = m_network->link(link);
+    if (m_linkClosed[link] || m_nodeClosed[l.to]) {
+        return kUnreachable;
+    }
+    return l.freeFlowSeconds + m_nodeDelay[l.to];
+}
+
+void Router::refreshLink(int link)
+{
+    double weight = linkWeight(link);
+    if (weight == m_weights[link]) {
+        return;
+    }
+    m_weights[link] = weight;
+    if (!m_dirty[link]) {
+        m_dirty[link] = 1;
+        m_dirtyLinks.push_back(link);
+    }
+}
+
+void Router::setNodeDelay(int node, double seconds)
+{
+    m_nodeDelay[node] = seconds;
+    for (int link : m_network->incoming(node)) {
+        refreshLink(link);
+    }
+}
+
+void Router::setNodeClosed(int node, bool closed)
+{
+    m_nodeClosed[node] = closed ? 1 : 0;
+    for (int link : m_network->incoming(node)) {
+        refreshLink(link);
+    }
+}
+
+void Router::setLinkClosed(int link, bool closed)
+{
+    m_linkClosed[link] = closed ? 1 : 0;
+    refreshLink(link);
+}
+
+// ----------------------------------------------------------------
+//   Queries and publication (simulation thread)
+// ----------------------------------------------------------------
+int Router::nextHop(int from, int dest)
+{
+    if (from == dest) {
+        return -1;
+    }
+
+    std::shared_ptr<const std::vector<int>> &hops = m_published[dest];
+    if (!hops) {
+        // Cache miss: solve now, hand the tree to the workers at the next sync
+        std::unique_ptr<Tree> tree(new Tree);
+        computeTree(dest, m_weights, *tree, m_scratch);
+        hops = nextHops(*tree);
+        m_adopted.emplace_back(dest, std::move(tree));
+        ++m_cachedTrees;
+    }
+    return (*hops)[from];
+}
+
+bool Router::sync(std::vector<std::pair<int, int>> &changed)
+{
+    changed.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_running > 0 || m_workers.empty()) {
+            return false;
+        }
+    }
+
+    // The workers are idle: everything below is owned by this thread until the next batch starts
+    bool published = false;
+    for (std::vector<Result> &results : m_results) {
+        for (Result &result : results) {
+            m_published[result.dest] = std::move(result.nextHops);
+            for (int node : result.changedNodes) {
+                changed.emplace_back(node, result.dest);
+            }
+            published = true;
+        }
+        results.clear();
+    }
+
+    for (auto &adopted : m_adopted) {
+        m_trees[adopted.first] = std::move(adopted.second);
+        m_treeDests.push_back(adopted.first);
+    }
+    m_adopted.clear();
+
+    if (!m_dirtyLinks.empty()) {
+        for (int link : m_dirtyLinks) {
+            m_batchWeights[link] = m_weights[link];
+            m_dirty[link] = 0;
+        }
+        m_batchLinks.swap(m_dirtyLinks);
+        m_dirtyLinks.clear();
+
+        if (!m_treeDests.empty()) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_running = static_cast<int>(m_workers.size());
+                ++m_generation;
+            }
+            m_batchReady.notify_all();
+        }
+    }
+    return published;
+}
+
+// ----------------------------------------------------------------
+//   Shortest-path trees
+// ----------------------------------------------------------------
+void Router::setNext(Tree &tree, int node, double dist, int link, Scratch &scratch) const
+{
+    if (scratch.saved[node] == kNotSaved) {
+        int next = tree.nextLink[node];
+        scratch.saved[node] = next >= 0 ? m_network->link(next).to : -1;
+        scratch.touched.push_back(node);
+    }
+    tree.dist[node] = dist;
+    tree.nextLink[node] = link;
+}
+
+void Router::propagate(Tree &tree, const std::vector<double> &weights, Scratch &scratch) const
+{
+    std::vector<std::pair<double, int>> &queue = scratch.queue;
+    while (!queue.empty()) {
+        std::pop_heap(queue.begin(), queue.end(), kCheaper);
+        std::pair<double, int> top = queue.back();
+        queue.pop_back();
+        if (top.first > tree.dist[top.second]) {
+            continue; // Stale entry
+        }
+
+        for (int link : m_network->incoming(top.second)) {
+            int from = m_network->link(link).from;
+            double cost = weights[link] + top.first;
+            if (cost < tree.dist[from] - kEpsilon) {
+                setNext(tree, from, cost, link, scratch);
+                queue.emplace_back(cost, from);
+                std::push_heap(queue.begin(), queue.end(), kCheaper);
+            }
+        }
+    }
+}
+
+void Router::computeTree(int dest, const std::vector<double> &weights, Tree &tree, Scratch &scratch) const
+{
+    int nodes = m_network->nodeCount();
+    tree.dist.assign(nodes, kUnreachable);
+    tree.nextLink.assign(nodes, -1);
+    tree.dist[dest] = 0.0;
+
+    scratch.queue.clear();
+    scratch.queue.emplace_back(0.0, dest);
+    propagate(tree, weights, scratch);
+
+    for (int node : scratch.touched) {
+        scratch.saved[node] = kNotSaved;
+    }
+    scratch.touched.clear();
+}
+
+void Router::repairTree(Tree &tree, const std::vector<int> &links, const std::vector<double> &weights,
+                        Scratch &scratch, std::vector<int> &changedNodes) const
+{
+    // Links are classified against the tree itself rather than their previous cost, so a tree
+    // solved on demand with newer costs than the batch started from is repaired correctly too.
+    std::vector<int> &affected = scratch.affectedList;
+    affected.clear();
+    for (int link : links) {
+        const RoadLink &l = m_network->link(link);
+        if (tree.nextLink[l.from] == link && tree.dist[l.from] < weights[link] + tree.dist[l.to] - kEpsilon
+            && !scratch.affected[l.from]) {
+            scratch.affected[l.from] = 1;
+            affected.push_back(l.from);
+        }
+    }
+
+    // Dearer tree links: collect every node whose path used one of them
+    for (std::size_t i = 0; i < affected.size(); ++i) {
+        for (int link : m_network->incoming(affected[i])) {
+            int from = m_network->link(link).from;
+            if (tree.nextLink[from] == link && !scratch.affected[from]) {
+                scratch.affected[from] = 1;
+                affected.push_back(from);
+            }
+        }
+    }
+    for (int node : affected) {
+        setNext(tree, node, kUnreachable, -1, scratch);
+    }
+
+    // Re-attach the invalidated subtree to its intact boundary
+    scratch.queue.clear();
+    for (int node : affected) {
+        for (int link : m_network->outgoing(node)) {
+            int to = m_network->link(link).to;
+            double cost = weights[link] + tree.dist[to];
+            if (!scratch.affected[to] && cost < tree.dist[node]) {
+                tree.dist[node] = cost;
+                tree.nextLink[node] = link;
+            }
+        }
+        if (tree.dist[node] < kUnreachable) {
+            scratch.queue.emplace_back(tree.dist[node], node);
+        }
+    }
+    for (int node : affected) {
+        scratch.affected[node] = 0;
+    }
+
+    // Cheaper links: seed improvements at their upstream end
+    for (int link : links) {
+        const RoadLink &l = m_network->link(link);
+        double cost = weights[link] + tree.dist[l.to];
+        if (cost < tree.dist[l.from] - kEpsilon) {
+            setNext(tree, l.from, cost, link, scratch);
+            scratch.queue.emplace_back(cost, l.from);
+        }
+    }
+    std::make_heap(scratch.queue.begin(), scratch.queue.end(), kCheaper);
+    propagate(tree, weights, scratch);
+
+    changedNodes.clear();
+    for (int node : scratch.touched) {
+        int next = tree.nextLink[node];
+        if ((next >= 0 ? m_network->link(next).to : -1) != scratch.saved[node]) {
+            changedNodes.push_back(node);
+        }
+        scratch.saved[node] = kNotSaved;
+    }
+    scratch.touched.clear();
+}
+
+std::shared_ptr<std::vector<int>> Router::nextHops(const Tree &tree) const
+{
+    std::shared_ptr<std::vector<int>> hops = std::make_shared<std::vector<int>>(tree.nextLink.size());
+    for (std::size_t node = 0; node < tree.nextLink.size(); ++node) {
+        int link = tree.nextLink[node];
+        (*hops)[node] = link >= 0 ? m_network->link(link).to : -1;
+    }
+    return hops;
+}
+
+// ----------------------------------------------------------------
+//   Background repair
+// ----------------------------------------------------------------
+void Router::workerLoop(int index)
+{
+    AllocationScope phase(AllocationPhase::Repair);
+    Scratch scratch;
+    scratch.affected.assign(m_network->nodeCount(), 0);
+    scratch.saved.assign(m_network->nodeCount(), kNotSaved);
+    std::vector<int> changedNodes;
+    unsigned seen = 0;
+
+    for (;;)
+    {
+        std::size_t stride;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_batchReady.wait(lock, [&] { return m_stopping || m_generation != seen; });
+            if (m_stopping) {
+                return;
+            }
+            seen = m_generation;
+            stride = m_results.size();
+        }
+
+        // Destinations are dealt out round-robin; each worker only touches its own trees and results
+        for (std::size_t i = static_cast<std::size_t>(index); i < m_treeDests.size(); i += stride) {
+            int dest = m_treeDests[i];
+            Tree &tree = *m_trees[dest];
+            repairTree(tree, m_batchLinks, m_batchWeights, scratch, changedNodes);
+            if (!changedNodes.empty()) {
+                m_results[index].push_back(Result{ dest, nextHops(tree), changedNodes });
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_running;
+    }
+}
@@ -0,0 +1,210 @@
+#pragma once
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "RoadNetwork.h"
+
+/**
+ * @class Router
+ * @brief Dynamic shortest-path routing over a RoadNetwork with cached per-destination trees.
+ *
+ * For every destination a vehicle has asked for, the router keeps a shortest-path tree giving
+ * each intersection's next hop toward that destination. Link costs change as queues grow and
+ * shrink or as roads close; instead of recomputing trees from scratch, changed links are handed
+ * to background threads in batches and each cached tree is repaired incrementally: a link that
+ * got cheaper propagates improvements from its upstream end, and a tree link that got dearer
+ * invalidates only the subtree hanging off it, which is then rebuilt from its intact boundary.
+ *
+ * The simulation thread never waits for the background threads. It keeps reading the last
+ * published trees, and sync() swaps in repaired trees at a step boundary once a batch finished,
+ * reporting which (node, destination) next hops changed so only the affected vehicles need to be
+ * re-routed.
+ *
+ * Node and link indices are zero-based; the caller converts to intersection ids.
+ */
+class Router {
+public:
+    /**
+     * @brief Constructor for the Router class.
+     */
+    Router();
+
+    /**
+     * @brief Destructor for the Router class. Joins the background threads.
+     */
+    ~Router();
+
+    Router(const Router &) = delete;
+    Router &operator=(const Router &) = delete;
+
+    /**
+     * @brief Drops every cached tree and starts routing over a network with free-flow costs.
+     *
+     * @param network The network to route over; must outlive the router or the next reset().
+     * @param threads The number of background repair threads.
+     */
+    void reset(const RoadNetwork *network, int threads);
+
+    /**
+     * @brief Stops the background threads, waiting for a running batch to finish.
+     */
+    void stop();
+
+    /**
+     * @brief Sets the expected queueing delay at a node; it is added to every link entering it.
+     *
+     * @param node The intersection index.
+     * @param seconds The expected delay in seconds.
+     */
+    void setNodeDelay(int node, double seconds);
+
+    /**
+     * @brief Closes or reopens a node. No route passes through or ends at a closed node.
+     *
+     * @param node The intersection index.
+     * @param closed True to close the node.
+     */
+    void setNodeClosed(int node, bool closed);
+
+    /**
+     * @brief Closes or reopens a single directed link.
+     *
+     * @param link The link index.
+     * @param closed True to close the link.
+     */
+    void setLinkClosed(int link, bool closed);
+
+    /**
+     * @brief Gets the next node on the current shortest path toward a destination.
+     *
+     * A destination seen for the first time is solved synchronously and cached; afterwards
+     * lookups are O(1).
+     *
+     * @param from The current node.
+     * @param dest The destination node.
+     * @return The next node, or -1 if from is the destination or the destination is unreachable.
+     */
+    int nextHop(int from, int dest);
+
+    /**
+     * @brief Publishes the trees of a finished repair batch and starts the next batch.
+     *
+     * Never blocks on the background threads: if a batch is still running, nothing happens and
+     * the changed links stay queued.
+     *
+     * @param changed Receives the (node, destination) pairs whose next hop changed (cleared first).
+     * @return True if a finished batch was published.
+     */
+    bool sync(std::vector<std::pair<int, int>> &changed);
+
+    /**
+     * @brief Gets the number of destinations with a cached tree.
+     */
+    int cachedTrees() const { return m_cachedTrees; }
+
+private:
+    /**
+     * @struct Tree
+     * @brief Shortest-path tree toward one destination.
+     */
+    struct Tree {
+        std::vector<double> dist; ///< Cost from each node to the destination.
+        std::vector<int> nextLink; ///< Link each node leaves by, or -1.
+    };
+
+    /**
+     * @struct Scratch
+     * @brief Per-thread working memory of the repair, reused across batches.
+     */
+    struct Scratch {
+        std::vector<std::pair<double, int>> queue; ///< Binary heap of (cost, node), cheapest first.
+        std::vector<char> affected; ///< Nodes whose tree path went through a dearer link.
+        std::vector<int> affectedList; ///< The nodes flagged in affected.
+        std::vector<int> saved; ///< Next hop of each touched node before the repair, or -2.
+        std::vector<int> touched; ///< Nodes whose next link was rewritten.
+    };
+
+    /**
+     * @struct Result
+     * @brief A repaired tree waiting to be published.
+     */
+    struct Result {
+        int dest; ///< The destination node.
+        std::shared_ptr<std::vector<int>> nextHops; ///< The new next hop of every node.
+        std::vector<int> changedNodes; ///< Nodes whose next hop changed.
+    };
+
+    /**
+     * @brief Computes the cost of a link from the current delays and closures.
+     */
+    double linkWeight(int link) const;
+
+    /**
+     * @brief Recomputes a link's cost and queues it for the next batch if it changed.
+     */
+    void refreshLink(int link);
+
+    /**
+     * @brief Runs a full backward Dijkstra from the destination.
+     */
+    void computeTree(int dest, const std::vector<double> &weights, Tree &tree, Scratch &scratch) const;
+
+    /**
+     * @brief Repairs a tree after the given links changed cost.
+     *
+     * @param changedNodes Receives the nodes whose next hop changed.
+     */
+    void repairTree(Tree &tree, const std::vector<int> &links, const std::vector<double> &weights,
+                    Scratch &scratch, std::vector<int> &changedNodes) const;
+
+    /**
+     * @brief Settles the queued nodes, relaxing links that lead into them.
+     */
+    void propagate(Tree &tree, const std::vector<double> &weights, Scratch &scratch) const;
+
+    /**
+     * @brief Rewrites a node's tree link, remembering its previous next hop once per repair.
+     */
+    void setNext(Tree &tree, int node, double dist, int link, Scratch &scratch) const;
+
+    /**
+     * @brief Converts a tree's next links into next-hop nodes.
+     */
+    std::shared_ptr<std::vector<int>> nextHops(const Tree &tree) const;
+
+    /**
+     * @brief Body of a background repair thread.
+     */
+    void workerLoop(int index);
+
+    const RoadNetwork *m_network; ///< The network being routed over.
+    int m_cachedTrees; ///< The number of destinations with a published tree.
+
+    // Simulation-thread state
+    std::vector<double> m_nodeDelay; ///< Expected queueing delay at each node.
+    std::vector<char> m_nodeClosed; ///< Closed nodes.
+    std::vector<char> m_linkClosed; ///< Closed links.
+    std::vector<double> m_weights; ///< The current cost of every link.
+    std::vector<char> m_dirty; ///< Links changed since the last batch.
+    std::vector<int> m_dirtyLinks; ///< The links flagged in m_dirty.
+    std::vector<std::shared_ptr<const std::vector<int>>> m_published; ///< Next hops per destination.
+    std::vector<std::pair<int, std::unique_ptr<Tree>>> m_adopted; ///< Trees solved on demand, not yet cached by the workers.
+    Scratch m_scratch; ///< Working memory of on-demand solves.
+
+    // Batch state, written by the simulation thread only while no batch is running
+    std::vector<double> m_batchWeights; ///< Link costs as seen by the workers.
+    std::vector<std::unique_ptr<Tree>> m_trees; ///< Cached trees per destination, repaired by the workers.
+    std::vector<int> m_treeDests; ///< Destinations with a cached tree.
+    std::vector<int> m_batchLinks; ///< Links changed in the running batch.
+    std::vector<std::vector<Result>> m_results; ///< Repaired trees per worker.
+
+    std::vector<std::thread> m_workers; ///< The background repair threads.
+    std::mutex m_mutex; ///< Guards the batch hand-off.
+    std::condition_variable m_batchReady; ///< Signals a new batch or shutdown.
+    unsigned m_generation; ///< Incremented for every batch.
+    int m_running; ///< Workers still repairing the current batch.
+    bool m_stopping; ///< Set when the workers should exit.
+};
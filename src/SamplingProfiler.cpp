@@ -0,0 +1,305 @@
+#include "SamplingProfiler.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <signal.h>
+#include <sys/time.h>
+#include <thread>
+#include <unordered_map>
+#ifdef __linux__
+#include <elf.h>
+#include <link.h>
+#endif
+
+namespace {
+
+const int kSkippedFrames = 2; ///< The handler itself and the kernel's signal trampoline.
+
+std::atomic<SamplingProfiler *> g_active(nullptr); ///< The profiler samples are recorded into.
+std::atomic<int> g_inHandler(0); ///< Handlers that may still touch g_active's buffer.
+struct sigaction g_previous; ///< The SIGPROF disposition before the first start().
+
+std::string demangle(const char *symbol)
+{
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(symbol, nullptr, nullptr, &status);
+    std::string name = (status == 0 && demangled) ? demangled : symbol;
+    std::free(demangled);
+    return name;
+}
+
+/**
+ * @brief The function symbols of the running executable's full symbol table (.symtab).
+ *
+ * dladdr only sees the dynamic symbol table, which lacks static and anonymous-namespace
+ * functions. Those are still named in .symtab unless the binary was stripped, so it is read from
+ * /proc/self/exe the first time a lookup needs it. Only available on Linux.
+ */
+class ExecutableSymbols {
+public:
+    ExecutableSymbols() : m_loaded(false), m_bias(0) {}
+
+    // The mangled name of the function containing address, or nullptr
+    const char *find(const char *address)
+    {
+        if (!m_loaded) {
+            load();
+        }
+        std::uintptr_t target = reinterpret_cast<std::uintptr_t>(address) - m_bias;
+        auto it = std::upper_bound(m_symbols.begin(), m_symbols.end(), target,
+                                   [](std::uintptr_t value, const Symbol &symbol) { return value < symbol.start; });
+        if (it == m_symbols.begin() || target >= (it - 1)->end) {
+            return nullptr;
+        }
+        return (it - 1)->name.c_str();
+    }
+
+private:
+    struct Symbol {
+        std::uintptr_t start; ///< First address, relative to the load bias.
+        std::uintptr_t end; ///< One past the last address.
+        std::string name; ///< Mangled name.
+    };
+
+    void load()
+    {
+        m_loaded = true;
+#ifdef __linux__
+        // The main program is reported first; its bias is 0 unless it is position independent
+        dl_iterate_phdr([](dl_phdr_info *info, std::size_t, void *bias) {
+            *static_cast<std::uintptr_t *>(bias) = info->dlpi_addr;
+            return 1;
+        }, &m_bias);
+
+        std::ifstream in("/proc/self/exe", std::ios::binary);
+        std::vector<char> image((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        const ElfW(Ehdr) *header = reinterpret_cast<const ElfW(Ehdr) *>(image.data());
+        if (image.size() < sizeof(ElfW(Ehdr)) || std::memcmp(header->e_ident, ELFMAG, SELFMAG) != 0
+            || header->e_shoff + header->e_shnum * sizeof(ElfW(Shdr)) > image.size()) {
+            return;
+        }
+
+        const ElfW(Shdr) *sections = reinterpret_cast<const ElfW(Shdr) *>(image.data() + header->e_shoff);
+        for (int i = 0; i < header->e_shnum; ++i)
+        {
+            const ElfW(Shdr) &table = sections[i];
+            if (table.sh_type != SHT_SYMTAB || table.sh_link >= header->e_shnum) {
+                continue;
+            }
+            const ElfW(Shdr) &strings = sections[table.sh_link];
+            if (table.sh_offset + table.sh_size > image.size() || strings.sh_offset + strings.sh_size > image.size()) {
+                continue;
+            }
+
+            const ElfW(Sym) *symbols = reinterpret_cast<const ElfW(Sym) *>(image.data() + table.sh_offset);
+            for (std::size_t s = 0; s < table.sh_size / sizeof(ElfW(Sym)); ++s)
+            {
+                const ElfW(Sym) &symbol = symbols[s];
+                // ELF64_ST_TYPE and ELF32_ST_TYPE extract the same bits
+                if (ELF64_ST_TYPE(symbol.st_info) != STT_FUNC || symbol.st_size == 0
+                    || symbol.st_name >= strings.sh_size) {
+                    continue;
+                }
+                const char *name = image.data() + strings.sh_offset + symbol.st_name;
+                m_symbols.push_back({ symbol.st_value, symbol.st_value + symbol.st_size,
+                                      std::string(name, strnlen(name, strings.sh_size - symbol.st_name)) });
+            }
+        }
+        std::sort(m_symbols.begin(), m_symbols.end(),
+                  [](const Symbol &a, const Symbol &b) { return a.start < b.start; });
+#endif
+    }
+
+    bool m_loaded; ///< True once load() has run.
+    std::uintptr_t m_bias; ///< Load bias of the executable.
+    std::vector<Symbol> m_symbols; ///< Function symbols sorted by start address.
+};
+
+// Resolves one frame; return addresses point past the call, so look one byte back
+std::string symbolName(void *address, bool exact, ExecutableSymbols &executable)
+{
+    const char *lookup = static_cast<const char *>(address) - (exact ? 0 : 1);
+    Dl_info info;
+    bool found = dladdr(lookup, &info) != 0;
+    if (found && info.dli_sname) {
+        return demangle(info.dli_sname);
+    }
+    if (const char *local = executable.find(lookup)) {
+        return demangle(local);
+    }
+    if (!found) {
+        return "[unknown]";
+    }
+
+    std::string module = info.dli_fname ? info.dli_fname : "[unknown]";
+    module = module.substr(module.find_last_of('/') + 1);
+    char offset[32];
+    std::snprintf(offset, sizeof(offset), "+0x%llx",
+                  static_cast<unsigned long long>(lookup - static_cast<const char *>(info.dli_fbase)));
+    return module + offset;
+}
+
+} // namespace
+
+// ----------------------------------------------------------------
+//   SamplingProfiler Constructor/Destructor
+// ----------------------------------------------------------------
+SamplingProfiler::SamplingProfiler(std::size_t capacity)
+    : m_samples(capacity),
+      m_next(0),
+      m_dropped(0),
+      m_running(false)
+{
+}
+
+SamplingProfiler::~SamplingProfiler()
+{
+    stop();
+}
+
+// ----------------------------------------------------------------
+//   Sampling
+// ----------------------------------------------------------------
+void SamplingProfiler::handleSignal(int)
+{
+    // Async-signal context: atomics and backtrace into preallocated memory only
+    int savedErrno = errno;
+    g_inHandler.fetch_add(1);
+    SamplingProfiler *profiler = g_active.load();
+    if (profiler) {
+        std::size_t slot = profiler->m_next.fetch_add(1, std::memory_order_relaxed);
+        if (slot < profiler->m_samples.size()) {
+            Sample &sample = profiler->m_samples[slot];
+            sample.depth = backtrace(sample.frames, kMaxDepth);
+        } else {
+            profiler->m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    g_inHandler.fetch_sub(1);
+    errno = savedErrno;
+}
+
+bool SamplingProfiler::start(int hz)
+{
+    if (m_running) {
+        return true;
+    }
+    SamplingProfiler *expected = nullptr;
+    if (hz <= 0 || !g_active.compare_exchange_strong(expected, this)) {
+        return false;
+    }
+
+    // The first backtrace() loads the unwinder, which allocates; do that here, not in the handler
+    void *warmup[1];
+    backtrace(warmup, 1);
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = &SamplingProfiler::handleSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    struct sigaction previous;
+    if (sigaction(SIGPROF, &action, &previous) != 0) {
+        g_active = nullptr;
+        return false;
+    }
+    if (previous.sa_handler != &SamplingProfiler::handleSignal) {
+        g_previous = previous;
+    }
+
+    long interval = std::max(1000000L / hz, 1L);
+    itimerval timer;
+    timer.it_interval.tv_sec = interval / 1000000;
+    timer.it_interval.tv_usec = interval % 1000000;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+        sigaction(SIGPROF, &g_previous, nullptr);
+        g_active = nullptr;
+        return false;
+    }
+
+    m_running = true;
+    return true;
+}
+
+void SamplingProfiler::stop()
+{
+    if (!m_running) {
+        return;
+    }
+
+    itimerval off;
+    std::memset(&off, 0, sizeof(off));
+    setitimer(ITIMER_PROF, &off, nullptr);
+
+    g_active = nullptr;
+    while (g_inHandler.load() > 0) {
+        std::this_thread::yield();
+    }
+
+    // A SIGPROF generated just before the timer was disarmed may still be pending. Under the
+    // default disposition it would terminate the process, so the no-op handler stays in that case.
+    if (g_previous.sa_handler != SIG_DFL) {
+        sigaction(SIGPROF, &g_previous, nullptr);
+    }
+    m_running = false;
+}
+
+std::size_t SamplingProfiler::sampleCount() const
+{
+    return std::min(m_next.load(std::memory_order_relaxed), m_samples.size());
+}
+
+// ----------------------------------------------------------------
+//   Symbolization & output
+// ----------------------------------------------------------------
+bool SamplingProfiler::writeFoldedStacks(const std::string &path, std::string &error) const
+{
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        error = "[Error] Could not open profile output: " + path + "\n";
+        return false;
+    }
+
+    // Each address is resolved once; identical stacks are merged
+    std::unordered_map<void *, std::string> names;
+    ExecutableSymbols executable;
+    std::map<std::string, std::size_t> stacks;
+    std::string stack;
+    for (std::size_t i = 0; i < sampleCount(); ++i)
+    {
+        const Sample &sample = m_samples[i];
+        stack.clear();
+        for (int f = sample.depth - 1; f >= kSkippedFrames; --f)
+        {
+            auto it = names.find(sample.frames[f]);
+            if (it == names.end()) {
+                // The innermost frame is the interrupted instruction itself, not a return address
+                it = names.emplace(sample.frames[f], symbolName(sample.frames[f], f == kSkippedFrames, executable)).first;
+            }
+            if (!stack.empty()) {
+                stack += ';';
+            }
+            stack += it->second;
+        }
+        ++stacks[stack.empty() ? "[unknown]" : stack];
+    }
+
+    for (const auto &entry : stacks) {
+        out << entry.first << ' ' << entry.second << '\n';
+    }
+    if (!out) {
+        error = "[Error] Could not write profile output: " + path + "\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @class SamplingProfiler
+ * @brief In-process statistical CPU profiler driven by SIGPROF.
+ *
+ * While running, setitimer(ITIMER_PROF) interrupts whichever thread is burning CPU at the chosen
+ * rate and the signal handler captures its call stack. Samples go into a buffer allocated up front;
+ * the handler claims a slot with one atomic increment and never allocates, locks or does I/O.
+ * When the buffer is full further samples are only counted as dropped.
+ *
+ * Symbolization happens after stop(): return addresses are resolved with dladdr and demangled, and
+ * identical stacks are merged into the folded format read by flame-graph tools
+ * (`outer;inner;leaf count` per line). On Linux, functions missing from the dynamic symbol table,
+ * such as static and anonymous-namespace helpers, are looked up in the executable's .symtab;
+ * anything still unnamed shows up as `module+0xoffset`.
+ *
+ * Only one profiler can run per process, since the interval timer and the signal are process-wide.
+ */
+class SamplingProfiler {
+public:
+    static const int kMaxDepth = 48; ///< Frames kept per sample.
+
+    /**
+     * @brief Constructor for the SamplingProfiler class.
+     *
+     * @param capacity The number of samples the buffer holds.
+     */
+    explicit SamplingProfiler(std::size_t capacity);
+
+    /**
+     * @brief Destructor for the SamplingProfiler class. Stops sampling if it is running.
+     */
+    ~SamplingProfiler();
+
+    SamplingProfiler(const SamplingProfiler &) = delete;
+    SamplingProfiler &operator=(const SamplingProfiler &) = delete;
+
+    /**
+     * @brief Installs the SIGPROF handler and arms the interval timer.
+     *
+     * Calling it while this profiler is already running does nothing.
+     *
+     * @param hz Samples per second of consumed CPU time.
+     * @return False if another profiler is running or the timer could not be armed.
+     */
+    bool start(int hz);
+
+    /**
+     * @brief Disarms the timer, restores the previous handler and waits for in-flight samples.
+     */
+    void stop();
+
+    /**
+     * @brief Checks whether the profiler is sampling.
+     */
+    bool running() const { return m_running; }
+
+    /**
+     * @brief Gets the number of samples captured so far.
+     */
+    std::size_t sampleCount() const;
+
+    /**
+     * @brief Gets the number of samples lost because the buffer was full.
+     */
+    std::size_t droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Symbolizes the captured samples and writes them as folded stacks.
+     *
+     * Must be called after stop().
+     *
+     * @param path The output file.
+     * @param error Receives a message if the file cannot be written.
+     * @return True if the file was written.
+     */
+    bool writeFoldedStacks(const std::string &path, std::string &error) const;
+
+private:
+    /**
+     * @struct Sample
+     * @brief One captured call stack, innermost frame first.
+     */
+    struct Sample {
+        int depth; ///< Number of valid frames.
+        void *frames[kMaxDepth]; ///< Return addresses.
+    };
+
+    /**
+     * @brief The SIGPROF handler; records a sample into the active profiler.
+     */
+    static void handleSignal(int signal);
+
+    std::vector<Sample> m_samples; ///< Preallocated sample buffer.
+    std::atomic<std::size_t> m_next; ///< Next free slot (may run past the capacity).
+    std::atomic<std::size_t> m_dropped; ///< Samples lost to a full buffer.
+    bool m_running; ///< True between start() and stop().
+};
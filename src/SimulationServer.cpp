@@ -0,0 +1,319 @@
+#include "SimulationServer.h"
+#include "TrafficSim.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const int kPollIntervalMs = 200; ///< How often blocked calls re-check for shutdown.
+
+// Waits until fd is ready for the given events, giving up once the server is stopping or, if
+// timeoutMs is not negative, once that long has passed without the fd becoming ready
+bool waitReady(int fd, short events, const std::atomic<bool> &stopping, int timeoutMs = -1)
+{
+    int waited = 0;
+    while (!stopping) {
+        pollfd p{ fd, events, 0 };
+        int r = poll(&p, 1, kPollIntervalMs);
+        if (r > 0) {
+            return true;
+        }
+        if (r < 0 && errno != EINTR) {
+            return false;
+        }
+        waited += kPollIntervalMs;
+        if (timeoutMs >= 0 && waited >= timeoutMs) {
+            return false;
+        }
+    }
+    return false;
+}
+
+// Reads exactly size bytes; false on EOF, error, shutdown or a peer idle for kReadTimeoutMs
+bool readAll(int fd, void *buffer, std::size_t size, const std::atomic<bool> &stopping)
+{
+    char *out = static_cast<char *>(buffer);
+    while (size > 0) {
+        if (!waitReady(fd, POLLIN, stopping, SimulationServer::kReadTimeoutMs)) {
+            return false;
+        }
+        ssize_t n = read(fd, out, size);
+        if (n == 0 || (n < 0 && errno != EINTR)) {
+            return false;
+        }
+        if (n > 0) {
+            out += n;
+            size -= static_cast<std::size_t>(n);
+        }
+    }
+    return true;
+}
+
+// Writes the whole buffer without raising SIGPIPE on a closed peer
+bool writeAll(int fd, const std::vector<unsigned char> &buffer)
+{
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+    std::size_t sent = 0;
+    while (sent < buffer.size()) {
+        ssize_t n = send(fd, buffer.data() + sent, buffer.size() - sent, flags);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+void putU32(std::vector<unsigned char> &out, std::uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<unsigned char>(value >> shift));
+    }
+}
+
+void putU64(std::vector<unsigned char> &out, std::uint64_t value)
+{
+    for (int shift = 0; shift < 64; shift += 8) {
+        out.push_back(static_cast<unsigned char>(value >> shift));
+    }
+}
+
+std::uint32_t getU32(const unsigned char *in)
+{
+    return static_cast<std::uint32_t>(in[0])
+        | static_cast<std::uint32_t>(in[1]) << 8
+        | static_cast<std::uint32_t>(in[2]) << 16
+        | static_cast<std::uint32_t>(in[3]) << 24;
+}
+
+} // namespace
+
+// ----------------------------------------------------------------
+//   SimulationServer Constructor/Destructor
+// ----------------------------------------------------------------
+SimulationServer::SimulationServer(const std::string &socketPath, int workers, int queueCapacity)
+    : m_socketPath(socketPath),
+      m_consoleSink(std::make_shared<NullSink>()),
+      m_errorSink(std::make_shared<NullSink>()),
+      m_workerCount(workers > 0 ? workers : 1),
+      m_queueCapacity(queueCapacity > 0 ? static_cast<std::size_t>(queueCapacity) : 1),
+      m_listenFd(-1),
+      m_stopping(false)
+{
+}
+
+SimulationServer::~SimulationServer()
+{
+    stop();
+    for (std::thread &worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+// ----------------------------------------------------------------
+//   Output
+// ----------------------------------------------------------------
+void SimulationServer::setSink(OutputChannel channel, std::shared_ptr<OutputSink> sink)
+{
+    if (!sink) {
+        sink = std::make_shared<NullSink>();
+    }
+    switch (channel) {
+    case OutputChannel::Console:
+        m_consoleSink = std::move(sink);
+        break;
+    case OutputChannel::Error:
+        m_errorSink = std::move(sink);
+        break;
+    case OutputChannel::Log:
+        break;
+    }
+}
+
+// ----------------------------------------------------------------
+//   run: accept loop
+// ----------------------------------------------------------------
+bool SimulationServer::run()
+{
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (m_socketPath.size() >= sizeof(addr.sun_path)) {
+        m_errorSink->write("[Error] Socket path too long: " + m_socketPath + "\n");
+        return false;
+    }
+    std::strncpy(addr.sun_path, m_socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    // Only a stale socket may be replaced; never delete a regular file passed by mistake
+    struct stat existing;
+    if (lstat(m_socketPath.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            m_errorSink->write("[Error] " + m_socketPath + " exists and is not a socket.\n");
+            return false;
+        }
+        unlink(m_socketPath.c_str());
+    }
+
+    m_listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_listenFd < 0) {
+        m_errorSink->write(std::string("[Error] Could not create socket: ") + std::strerror(errno) + "\n");
+        return false;
+    }
+    if (bind(m_listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0
+        || listen(m_listenFd, static_cast<int>(m_queueCapacity)) < 0) {
+        m_errorSink->write("[Error] Could not listen on " + m_socketPath + ": " + std::strerror(errno) + "\n");
+        close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+
+    for (int i = 0; i < m_workerCount; ++i) {
+        m_workers.emplace_back(&SimulationServer::workerLoop, this);
+    }
+    m_consoleSink->write("[Info] Serving scenarios on " + m_socketPath + " with "
+                         + std::to_string(m_workerCount) + " workers.\n");
+
+    while (waitReady(m_listenFd, POLLIN, m_stopping)) {
+        int fd = accept(m_listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+
+        // Bounded queue: stop accepting until a worker frees a spot
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (m_queue.size() >= m_queueCapacity && !m_stopping) {
+            m_queueSpace.wait_for(lock, std::chrono::milliseconds(kPollIntervalMs));
+        }
+        if (m_stopping) {
+            close(fd);
+            break;
+        }
+        m_queue.push_back(fd);
+        lock.unlock();
+        m_queueReady.notify_one();
+    }
+
+    // Shutdown: wake the workers, drop connections nobody picked up
+    m_stopping = true;
+    m_queueReady.notify_all();
+    for (std::thread &worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+    for (int fd : m_queue) {
+        close(fd);
+    }
+    m_queue.clear();
+
+    close(m_listenFd);
+    m_listenFd = -1;
+    unlink(m_socketPath.c_str());
+    return true;
+}
+
+// ----------------------------------------------------------------
+//   Workers
+// ----------------------------------------------------------------
+int SimulationServer::nextConnection()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_queue.empty()) {
+        if (m_stopping) {
+            return -1;
+        }
+        m_queueReady.wait_for(lock, std::chrono::milliseconds(kPollIntervalMs));
+    }
+    int fd = m_queue.front();
+    m_queue.pop_front();
+    lock.unlock();
+    m_queueSpace.notify_one();
+    return fd;
+}
+
+void SimulationServer::workerLoop()
+{
+    // One simulation per worker, re-initialized in place for every scenario
+    TrafficSim sim;
+    sim.setRecordHistory(false);
+    auto errors = std::make_shared<StringSink>();
+    sim.setSink(OutputChannel::Error, errors);
+
+    std::string config;
+    std::vector<unsigned char> response;
+
+    for (int fd = nextConnection(); fd >= 0; fd = nextConnection())
+    {
+        unsigned char lengthBytes[4];
+        while (readAll(fd, lengthBytes, sizeof(lengthBytes), m_stopping))
+        {
+            // An oversized body is never read, so the connection ends after the answer
+            std::uint32_t length = getU32(lengthBytes);
+            const bool tooLarge = length > kMaxConfigLength;
+            errors->clear();
+            bool ok = false;
+            int steps = 0;
+            if (tooLarge) {
+                errors->write("[Error] Config too large: " + std::to_string(length) + " bytes (limit "
+                              + std::to_string(kMaxConfigLength) + ").\n");
+            } else {
+                config.resize(length);
+                if (length > 0 && !readAll(fd, &config[0], length, m_stopping)) {
+                    break;
+                }
+
+                // A bad scenario fails its own request, never the daemon
+                try {
+                    std::istringstream in(config);
+                    ok = sim.initialize(in);
+                    // The profiler's SIGPROF timer is process-wide, so it cannot serve one request
+                    if (ok && !sim.getProfilerOutput().empty()) {
+                        errors->write("[Error] profiler_output is not supported in server requests.\n");
+                        ok = false;
+                    }
+                    steps = ok ? sim.step(sim.getMaxSteps()) : 0;
+                } catch (const std::exception &e) {
+                    errors->write(std::string("[Error] Scenario failed: ") + e.what() + "\n");
+                    ok = false;
+                }
+            }
+
+            response.clear();
+            putU32(response, kResponseMagic);
+            putU32(response, ok ? 0u : 1u);
+            putU32(response, static_cast<std::uint32_t>(steps));
+            putU32(response, ok ? static_cast<std::uint32_t>(sim.getIntersections().size()) : 0u);
+            putU64(response, ok ? sim.getVehicles().issuedCount() : 0u);
+            putU64(response, ok ? sim.getVehicles().size() : 0u);
+            putU32(response, static_cast<std::uint32_t>(errors->text().size()));
+            response.insert(response.end(), errors->text().begin(), errors->text().end());
+            if (ok) {
+                for (const Intersection &inter : sim.getIntersections()) {
+                    putU32(response, static_cast<std::uint32_t>(inter.getId()));
+                    putU32(response, static_cast<std::uint32_t>(inter.getThroughput()));
+                    putU32(response, static_cast<std::uint32_t>(inter.getWaitingCount()));
+                }
+            }
+
+            if (!writeAll(fd, response) || tooLarge) {
+                break;
+            }
+        }
+        close(fd);
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "OutputSink.h"
+
+/**
+ * @class SimulationServer
+ * @brief Long-lived server running scenario requests received over a Unix-domain socket.
+ *
+ * Each worker thread owns one TrafficSim that is re-initialized in place for every scenario, so
+ * process start-up and reconstruction of intersections and vehicle storage are paid once per
+ * worker instead of once per run. Accepted connections wait in a bounded queue; when it is full
+ * the acceptor stops accepting, which pushes back on clients. A connection that sends nothing for
+ * kReadTimeoutMs is dropped so idle clients cannot hold a worker. Like TrafficSim, the server
+ * writes nothing unless a sink is attached.
+ *
+ * Wire protocol (all integers little-endian, unsigned). A connection may carry any number of
+ * requests; each is answered before the next one is read.
+ *
+ * Request:
+ *   u32 configLength, then configLength bytes of `key = value` config text.
+ *
+ * Response:
+ *   u32 magic ('TSR1' = 0x31525354), u32 status (0 = ok, 1 = invalid config or failed run),
+ *   u32 stepsExecuted, u32 intersectionCount, u64 vehiclesSpawned, u64 vehiclesInNetwork,
+ *   u32 messageLength, messageLength bytes of error text,
+ *   then intersectionCount records of { u32 id, u32 throughput, u32 waiting }.
+ */
+class SimulationServer {
+public:
+    static const std::uint32_t kResponseMagic = 0x31525354u; ///< "TSR1" read as little-endian.
+    static const std::uint32_t kMaxConfigLength = 1u << 20; ///< Larger requests get status 1 and the connection is closed.
+    static const int kReadTimeoutMs = 10000; ///< Connections idle for longer are closed.
+
+    /**
+     * @brief Constructor for the SimulationServer class.
+     *
+     * @param socketPath The filesystem path of the Unix-domain socket to listen on.
+     * @param workers The number of scenarios run concurrently.
+     * @param queueCapacity The number of accepted connections that may wait for a worker.
+     */
+    SimulationServer(const std::string &socketPath, int workers, int queueCapacity);
+
+    /**
+     * @brief Destructor for the SimulationServer class. Stops the server if it is running.
+     */
+    ~SimulationServer();
+
+    SimulationServer(const SimulationServer &) = delete;
+    SimulationServer &operator=(const SimulationServer &) = delete;
+
+    /**
+     * @brief Routes the server's own messages to a sink. Every channel starts as a NullSink.
+     *
+     * Console receives start-up messages and Error receives socket errors; Log is unused. Must be
+     * called before run().
+     *
+     * @param channel The output channel to redirect.
+     * @param sink The new destination; nullptr restores the NullSink.
+     */
+    void setSink(OutputChannel channel, std::shared_ptr<OutputSink> sink);
+
+    /**
+     * @brief Binds the socket, starts the workers and accepts connections until stop() is called.
+     *
+     * An existing file at the socket path is only replaced if it is a socket (a stale one left by
+     * an earlier run).
+     *
+     * @return True if the server shut down cleanly, false if the socket could not be set up.
+     */
+    bool run();
+
+    /**
+     * @brief Asks run() to return. Safe to call from a signal handler.
+     */
+    void stop() { m_stopping = true; }
+
+private:
+    /**
+     * @brief Body of a worker thread: serves queued connections with its own simulation.
+     */
+    void workerLoop();
+
+    /**
+     * @brief Takes the next queued connection, blocking until one arrives or the server stops.
+     *
+     * @return The connection descriptor, or -1 once the server is stopping.
+     */
+    int nextConnection();
+
+    std::string m_socketPath; ///< Path of the listening socket.
+    std::shared_ptr<OutputSink> m_consoleSink; ///< Receives start-up messages.
+    std::shared_ptr<OutputSink> m_errorSink; ///< Receives socket errors.
+    int m_workerCount; ///< The number of worker threads.
+    std::size_t m_queueCapacity; ///< The maximum number of waiting connections.
+    int m_listenFd; ///< The listening socket descriptor.
+
+    std::atomic<bool> m_stopping; ///< Set once the server should shut down.
+    std::vector<std::thread> m_workers; ///< The worker threads.
+    std::deque<int> m_queue; ///< Accepted connections waiting for a worker.
+    std::mutex m_mutex; ///< Guards m_queue.
+    std::condition_variable m_queueReady; ///< Signals a queued connection or shutdown.
+    std::condition_variable m_queueSpace; ///< Signals room in the queue.
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+
+/**
+ * @class Span
+ * @brief Non-owning view of a contiguous array (a minimal C++14 stand-in for std::span).
+ *
+ * A span is only valid while the storage it points into is neither destroyed nor resized.
+ *
+ * @tparam T The element type, usually const-qualified.
+ */
+template <typename T>
+class Span {
+public:
+    /**
+     * @brief Constructor for an empty Span.
+     */
+    Span()
+        : m_data(nullptr), m_size(0) {}
+
+    /**
+     * @brief Constructor for the Span class.
+     *
+     * @param data Pointer to the first element.
+     * @param size The number of elements.
+     */
+    Span(T *data, std::size_t size)
+        : m_data(data), m_size(size) {}
+
+    /**
+     * @brief Gets a pointer to the first element.
+     */
+    T *data() const { return m_data; }
+
+    /**
+     * @brief Gets the number of elements.
+     */
+    std::size_t size() const { return m_size; }
+
+    /**
+     * @brief Checks whether the span has no elements.
+     */
+    bool empty() const { return m_size == 0; }
+
+    /**
+     * @brief Accesses an element without bounds checking.
+     *
+     * @param index The position of the element.
+     * @return A reference to the element.
+     */
+    T &operator[](std::size_t index) const { return m_data[index]; }
+
+    /**
+     * @brief Iterator to the first element.
+     */
+    T *begin() const { return m_data; }
+
+    /**
+     * @brief Iterator past the last element.
+     */
+    T *end() const { return m_data + m_size; }
+
+private:
+    T *m_data; ///< The first element of the viewed array.
+    std::size_t m_size; ///< The number of viewed elements.
+};
@@ -0,0 +1,142 @@
+#include "SteadyStateDetector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Two-sided 95% Student-t quantiles for 1..30 degrees of freedom
+const double kStudentT[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+double studentT(int df)
+{
+    if (df <= 30) {
+        return kStudentT[std::max(df, 1) - 1];
+    }
+    return 1.96 + 2.5 / df; // Within 0.002 of the exact quantile beyond 30
+}
+
+} // namespace
+
+SteadyStateDetector::SteadyStateDetector()
+    : m_seriesCount(0),
+      m_cutSeries(0),
+      m_batchSize(1),
+      m_minBatches(2),
+      m_tolerance(0.0),
+      m_stepInBatch(0),
+      m_batches(0),
+      m_cutBatches(0),
+      m_converged(false)
+{
+}
+
+void SteadyStateDetector::configure(int seriesCount, int cutSeries, int batchSize, int minBatches, double tolerance)
+{
+    m_seriesCount = seriesCount;
+    m_cutSeries = std::min(std::max(cutSeries, 1), seriesCount);
+    m_batchSize = std::max(batchSize, 1);
+    m_minBatches = std::min(std::max(minBatches, 2), kMaxBatches / 2);
+    m_tolerance = tolerance;
+    m_stepInBatch = 0;
+    m_batches = 0;
+    m_cutBatches = 0;
+    m_converged = false;
+
+    m_batchSum.assign(seriesCount, 0.0);
+    m_means.assign(static_cast<std::size_t>(seriesCount) * kMaxBatches, 0.0);
+    m_mean.assign(seriesCount, 0.0);
+    m_halfWidth.assign(seriesCount, 0.0);
+}
+
+bool SteadyStateDetector::endStep()
+{
+    // A full batch list is merged only once the next step arrives, so after an evaluation on the
+    // last batch the cut, batch size and batch count still describe the batches it used
+    if (m_batches == kMaxBatches) {
+        mergeBatches();
+    }
+    if (++m_stepInBatch < m_batchSize) {
+        return m_converged;
+    }
+
+    // Close the batch for every series
+    for (int s = 0; s < m_seriesCount; ++s) {
+        m_means[static_cast<std::size_t>(s) * kMaxBatches + m_batches] = m_batchSum[s] / m_batchSize;
+        m_batchSum[s] = 0.0;
+    }
+    m_stepInBatch = 0;
+    ++m_batches;
+
+    evaluate();
+    return m_converged;
+}
+
+void SteadyStateDetector::mergeBatches()
+{
+    for (int s = 0; s < m_seriesCount; ++s) {
+        double *means = &m_means[static_cast<std::size_t>(s) * kMaxBatches];
+        for (int i = 0; i < kMaxBatches / 2; ++i) {
+            means[i] = 0.5 * (means[2 * i] + means[2 * i + 1]);
+        }
+    }
+    m_batches = kMaxBatches / 2;
+    m_cutBatches /= 2;
+    m_batchSize *= 2;
+}
+
+void SteadyStateDetector::evaluate()
+{
+    const int k = m_batches;
+
+    // MSER on the cut series; their latest cut is applied to every series
+    int cut = 0;
+    for (int s = 0; s < m_cutSeries; ++s) {
+        const double *means = &m_means[static_cast<std::size_t>(s) * kMaxBatches];
+        double sum = 0.0;
+        double sumSq = 0.0;
+        for (int i = 0; i < k; ++i) {
+            sum += means[i];
+            sumSq += means[i] * means[i];
+        }
+
+        int best = 0;
+        double bestScore = 0.0;
+        for (int d = 0; d <= k / 2; ++d) {
+            double m = k - d;
+            double score = (sumSq - sum * sum / m) / (m * m);
+            if (d == 0 || score < bestScore) {
+                best = d;
+                bestScore = score;
+            }
+            sum -= means[d];
+            sumSq -= means[d] * means[d];
+        }
+        cut = std::max(cut, best);
+    }
+    m_cutBatches = cut;
+
+    // Batch-means confidence interval of every series after the cut
+    const int m = k - cut;
+    bool steady = m >= m_minBatches;
+    for (int s = 0; s < m_seriesCount; ++s) {
+        const double *means = &m_means[static_cast<std::size_t>(s) * kMaxBatches] + cut;
+        double sum = 0.0;
+        double sumSq = 0.0;
+        for (int i = 0; i < m; ++i) {
+            sum += means[i];
+            sumSq += means[i] * means[i];
+        }
+        double mean = m > 0 ? sum / m : 0.0;
+        double variance = m > 1 ? std::max(sumSq - sum * mean, 0.0) / (m - 1) : 0.0;
+        double halfWidth = m > 1 ? studentT(m - 1) * std::sqrt(variance / m) : 0.0;
+
+        m_mean[s] = mean;
+        m_halfWidth[s] = halfWidth;
+        steady = steady && halfWidth <= m_tolerance * std::max(std::fabs(mean), 1.0);
+    }
+    m_converged = steady;
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <vector>
+
+/**
+ * @class SteadyStateDetector
+ * @brief Online warm-up removal and convergence test over many per-step series.
+ *
+ * Observations are folded into batch means as they arrive, so memory stays at a fixed number of
+ * batches per series: when the batch list is full, neighbouring batches are merged and the batch
+ * size doubles at the start of the next step. At every batch boundary the detector
+ *   1. picks the warm-up cut with MSER (the truncation point d that minimizes the variance of the
+ *      remaining batch means divided by their count squared, searched over the first half) on the
+ *      leading cut series only, taking the latest of their cuts so one cut applies to the whole
+ *      run (these should be a few low-noise aggregates: over many noisy series the latest cut is
+ *      nearly always pinned at the search limit), and
+ *   2. checks every series' batch means after the cut: the run is steady once each 95% confidence
+ *      half-width is within tolerance of its mean (or of 1 for series that average below 1).
+ */
+class SteadyStateDetector {
+public:
+    static const int kMaxBatches = 40; ///< Batches kept per series before neighbours are merged.
+
+    /**
+     * @brief Constructor for the SteadyStateDetector class. The detector starts unconfigured.
+     */
+    SteadyStateDetector();
+
+    /**
+     * @brief Starts a new detection run, discarding every observation.
+     *
+     * @param seriesCount The number of series observed each step.
+     * @param cutSeries The number of leading series whose MSER cuts choose the warm-up cut (1 to seriesCount).
+     * @param batchSize The initial number of steps per batch.
+     * @param minBatches The number of batches that must remain after the warm-up cut (2 to kMaxBatches / 2).
+     * @param tolerance The allowed confidence half-width relative to the mean.
+     */
+    void configure(int seriesCount, int cutSeries, int batchSize, int minBatches, double tolerance);
+
+    /**
+     * @brief Adds the current step's value of one series.
+     *
+     * @param series The series index.
+     * @param value The observed value.
+     */
+    void record(int series, double value) { m_batchSum[series] += value; }
+
+    /**
+     * @brief Closes the current step and evaluates the series whenever a batch completes.
+     *
+     * @return True once every series is stationary within the tolerance.
+     */
+    bool endStep();
+
+    /**
+     * @brief Checks whether the last evaluation found every series stationary.
+     */
+    bool converged() const { return m_converged; }
+
+    /**
+     * @brief Gets the number of leading steps the last evaluation discarded as warm-up.
+     */
+    int warmupSteps() const { return m_cutBatches * m_batchSize; }
+
+    /**
+     * @brief Gets the current number of steps per batch.
+     */
+    int batchSize() const { return m_batchSize; }
+
+    /**
+     * @brief Gets the number of completed batches.
+     */
+    int batchCount() const { return m_batches; }
+
+    /**
+     * @brief Gets a series' mean after the warm-up cut, as of the last evaluation.
+     */
+    double mean(int series) const { return m_mean[series]; }
+
+    /**
+     * @brief Gets a series' 95% confidence half-width, as of the last evaluation.
+     */
+    double halfWidth(int series) const { return m_halfWidth[series]; }
+
+private:
+    /**
+     * @brief Merges neighbouring batches pairwise and doubles the batch size.
+     */
+    void mergeBatches();
+
+    /**
+     * @brief Runs MSER truncation and the confidence test over every series.
+     */
+    void evaluate();
+
+    int m_seriesCount; ///< The number of series.
+    int m_cutSeries; ///< Leading series that choose the warm-up cut.
+    int m_batchSize; ///< Steps per batch.
+    int m_minBatches; ///< Batches required after the warm-up cut.
+    double m_tolerance; ///< Allowed relative half-width.
+
+    int m_stepInBatch; ///< Steps recorded into the open batch.
+    int m_batches; ///< Completed batches per series.
+    int m_cutBatches; ///< Batches discarded as warm-up by the last evaluation.
+    bool m_converged; ///< Result of the last evaluation.
+
+    std::vector<double> m_batchSum; ///< Running sum of the open batch per series.
+    std::vector<double> m_means; ///< Batch means, kMaxBatches per series.
+    std::vector<double> m_mean; ///< Mean after the cut per series.
+    std::vector<double> m_halfWidth; ///< Confidence half-width per series.
+};
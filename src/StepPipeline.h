@@ -0,0 +1,194 @@
+#pragma once
+#include "AllocationTracker.h"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class StepPipeline
+ * @brief Runs per-step consumer stages on their own threads over double-buffered snapshots.
+ *
+ * The producer (the simulation thread) fills one buffer while the stages read the other, so
+ * step N's stages overlap with step N+1's simulation work. Each stage consumes snapshots strictly
+ * in order and only ever sees them through a const reference. At steady state a step costs about
+ * as much as the slowest stage instead of the sum of all stages.
+ *
+ * @tparam Snapshot The per-step state handed to the stages. Buffers are reused, never reallocated.
+ */
+template <typename Snapshot>
+class StepPipeline {
+public:
+    using Stage = std::function<void(const Snapshot &)>; ///< A consumer of published snapshots.
+
+    /**
+     * @brief Constructor for the StepPipeline class.
+     */
+    StepPipeline()
+        : m_published(0),
+          m_registered(0),
+          m_running(false),
+          m_stopping(false) {
+        m_pending[0] = 0;
+        m_pending[1] = 0;
+    }
+
+    /**
+     * @brief Destructor for the StepPipeline class. Finishes outstanding snapshots and joins the stages.
+     */
+    ~StepPipeline() { stop(); }
+
+    StepPipeline(const StepPipeline &) = delete;
+    StepPipeline &operator=(const StepPipeline &) = delete;
+
+    /**
+     * @brief Registers a stage. Must be called before start().
+     *
+     * @param stage The callback run for every published snapshot.
+     */
+    void addStage(Stage stage) {
+        m_stages.push_back(StageState{ std::move(stage), 0, -1, std::thread() });
+    }
+
+    /**
+     * @brief Starts one thread per registered stage.
+     *
+     * Returns once every stage thread has claimed its allocation counter block.
+     */
+    void start() {
+        if (m_running) {
+            return;
+        }
+        m_stopping = false;
+        m_running = true;
+        m_registered = 0;
+        for (std::size_t i = 0; i < m_stages.size(); ++i) {
+            m_stages[i].consumed = m_published;
+            m_stages[i].thread = std::thread(&StepPipeline::stageLoop, this, i);
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_released.wait(lock, [&] { return m_registered == m_stages.size(); });
+    }
+
+    /**
+     * @brief Gets the number of registered stages.
+     */
+    std::size_t stageCount() const { return m_stages.size(); }
+
+    /**
+     * @brief Gets the allocation counter block of a running stage's thread.
+     *
+     * @param index The stage, in registration order.
+     * @return The block from AllocationTracker::threadBlock(), -1 if the stage is not running.
+     */
+    int allocationBlock(std::size_t index) const { return m_running ? m_stages[index].allocationBlock : -1; }
+
+    /**
+     * @brief Gets the buffer to fill for the next step.
+     *
+     * Blocks until every stage has finished reading the snapshot previously stored in that buffer.
+     *
+     * @return The writable back buffer.
+     */
+    Snapshot &acquire() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        int buffer = static_cast<int>(m_published % 2);
+        m_released.wait(lock, [&] { return m_pending[buffer] == 0; });
+        return m_buffers[buffer];
+    }
+
+    /**
+     * @brief Hands the buffer returned by acquire() to every stage.
+     */
+    void publish() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending[m_published % 2] = m_running ? static_cast<int>(m_stages.size()) : 0;
+            m_published++;
+        }
+        m_available.notify_all();
+    }
+
+    /**
+     * @brief Blocks until every stage has consumed every published snapshot.
+     */
+    void drain() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_released.wait(lock, [&] { return m_pending[0] == 0 && m_pending[1] == 0; });
+    }
+
+    /**
+     * @brief Drains outstanding snapshots and joins the stage threads.
+     */
+    void stop() {
+        if (!m_running) {
+            return;
+        }
+        drain();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_available.notify_all();
+        for (StageState &stage : m_stages) {
+            stage.thread.join();
+        }
+        m_running = false;
+    }
+
+private:
+    /**
+     * @struct StageState
+     * @brief A registered stage and its progress through the published snapshots.
+     */
+    struct StageState {
+        Stage run; ///< The stage callback.
+        std::uint64_t consumed; ///< The number of snapshots this stage has finished.
+        int allocationBlock; ///< The stage thread's allocation counter block.
+        std::thread thread; ///< The thread running the stage.
+    };
+
+    /**
+     * @brief Body of a stage thread: consumes snapshots in order until stopped.
+     *
+     * @param index The index of the stage in m_stages.
+     */
+    void stageLoop(std::size_t index) {
+        StageState &stage = m_stages[index];
+        int block = AllocationTracker::threadBlock();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        stage.allocationBlock = block;
+        ++m_registered;
+        m_released.notify_all();
+        for (;;) {
+            m_available.wait(lock, [&] { return m_stopping || stage.consumed < m_published; });
+            if (stage.consumed == m_published) {
+                return;
+            }
+            int buffer = static_cast<int>(stage.consumed % 2);
+
+            lock.unlock();
+            stage.run(m_buffers[buffer]);
+            lock.lock();
+
+            stage.consumed++;
+            if (--m_pending[buffer] == 0) {
+                m_released.notify_all();
+            }
+        }
+    }
+
+    Snapshot m_buffers[2]; ///< The front and back snapshot buffers.
+    int m_pending[2]; ///< Stages still reading each buffer.
+    std::uint64_t m_published; ///< The number of snapshots published so far.
+    std::size_t m_registered; ///< Stage threads that have claimed their counter block since start().
+    bool m_running; ///< True while the stage threads are alive.
+    bool m_stopping; ///< Asks the stage threads to exit once drained.
+
+    std::vector<StageState> m_stages; ///< The registered stages.
+    std::mutex m_mutex; ///< Guards the counters above.
+    std::condition_variable m_available; ///< Signals a newly published snapshot.
+    std::condition_variable m_released; ///< Signals that a buffer has been fully consumed or a stage has registered.
+};
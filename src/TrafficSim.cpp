@@ -1,10 +1,12 @@
 #include "TrafficSim.h"
 #include "Car.h"
 #include "Truck.h"
-#include <iostream>
+#include <fstream>
 #include <algorithm>
+#include <cmath>
 #include <thread>
 #include <chrono>
+#include <cctype>
 #include <sstream>
 
 // ----------------------------------------------------------------
@@ -17,16 +19,27 @@ static const char *ANSI_YELLOW = "\x1b[33m";
 static const char *ANSI_RESET = "\x1b[0m";
 
 static const char spinnerChars[] = {'|', '/', '-', '\\'};
-static int spinnerIndex = 0;
 
-// Helper to show a rotating spinner or progress
-static void printSpinner(int currentStep, int totalSteps)
+// Routing cost model: free-flow speed on the roads between intersections and the time one
+// queued vehicle needs to clear a stop line while it is green
+static const double kFreeFlowSpeed = 13.9;
+static const double kSaturationHeadway = 2.0;
+static const int kDestinationDraws = 8;
+
+// Steady-state series 0 and 1 are the network's passed and waiting totals; they choose the warm-up cut
+static const int kNetworkSeries = 2;
+
+// Sampling profiler buffer (~13 MB): about five minutes of one busy thread at the default 99 Hz
+static const std::size_t kProfilerSamples = 1 << 15;
+
+// Helper to show a rotating spinner or progress; frame is the caller's spinner position
+static void printSpinner(std::ostream &os, int currentStep, int totalSteps, int &frame)
 {
     double fraction = (double)currentStep / totalSteps * 100.0;
     // e.g. "[Step 3/10] Progress: 30% /
-    std::cout << "[Step " << currentStep << "/" << totalSteps << "] ";
-    std::cout << "Progress: " << (int)fraction << "% ";
-    std::cout << spinnerChars[spinnerIndex++ % 4] << "\n";
+    os << "[Step " << currentStep << "/" << totalSteps << "] ";
+    os << "Progress: " << (int)fraction << "% ";
+    os << spinnerChars[frame++ % 4] << "\n";
 }
 
 // We can use a utility function to repeat a character (for bar charts)
@@ -37,6 +50,52 @@ static std::string repeatChar(char c, int times)
     return std::string(times, c);
 }
 
+// Strips leading and trailing whitespace (config keys)
+static std::string trim(const std::string &text)
+{
+    std::size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos)
+        return "";
+    std::size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+// Reads the first token of a config value; anything after it (e.g. a comment) is ignored.
+// Leaves out untouched and returns false if the token is missing or not a T.
+template <typename T>
+static bool readValue(const std::string &text, T &out)
+{
+    std::istringstream in(text);
+    T value;
+    if (!(in >> value)) {
+        return false;
+    }
+    int next = in.peek();
+    if (next != EOF && !std::isspace(next)) {
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+// Reads a 0/1 config switch
+static bool readFlag(const std::string &text, bool &out)
+{
+    int flag = 0;
+    if (!readValue(text, flag)) {
+        return false;
+    }
+    out = flag != 0;
+    return true;
+}
+
+// The published state of one intersection
+static TrafficSim::IntersectionRecord snapshotOf(const Intersection &inter)
+{
+    return TrafficSim::IntersectionRecord{ inter.getId(), inter.isGreen(), inter.getWaitingCount(),
+                                           inter.getPassedThisStep(), inter.getThroughput() };
+}
+
 // ----------------------------------------------------------------
 //   TrafficSim Constructor/Destructor
 // ----------------------------------------------------------------
@@ -46,14 +105,67 @@ TrafficSim::TrafficSim()
       m_maxSteps(0),
       m_greenTime(3),
       m_redTime(2),
-      m_currentStep(0)
+      m_laneLength(200.0),
+      m_stepSeconds(1.0),
+      m_subSteps(10),
+      m_frameDelayMs(800),
+      m_consoleSink(std::make_shared<NullSink>()),
+      m_logSink(std::make_shared<NullSink>()),
+      m_errorSink(std::make_shared<NullSink>()),
+      m_currentStep(0),
+      m_sparseSnapshots(false),
+      m_dashboardTopK(0),
+      m_networkWaiting(0),
+      m_networkThroughput(0),
+      m_networkPassed(0),
+      m_spinnerFrame(0),
+      m_routing(false),
+      m_routingThreads(1),
+      m_routeCostThreshold(0.25),
+      m_steadyStateDetection(false),
+      m_steadyStateTolerance(0.05),
+      m_steadyStateBatchSize(5),
+      m_steadyStateMinBatches(10),
+      m_stopReason(StopReason::Running),
+      m_profilerHz(99),
+      m_allocationReport(false),
+      m_allocationBudget(-1),
+      m_allocationTracking(false),
+      m_allocationStart(),
+      m_allocationMark(),
+      m_allocationBlocks(),
+      m_stepAllocationMark(),
+      m_allocationPeak(0),
+      m_allocationBudgetViolations(0),
+      m_hasSeed(false),
+      m_seed(0),
+      m_recordHistory(true)
 {
+    m_pipeline.addStage([this](const StepRecord &record) { recordStepData(record); });
+    m_pipeline.addStage([this](const StepRecord &record) { logStepData(record); });
+    m_pipeline.addStage([this](const StepRecord &record) { renderStep(record); });
 }
 
 TrafficSim::~TrafficSim()
 {
-    if (m_logFile.is_open()) {
-        m_logFile.close();
+    m_pipeline.stop();
+}
+
+void TrafficSim::setSink(OutputChannel channel, std::shared_ptr<OutputSink> sink)
+{
+    if (!sink) {
+        sink = std::make_shared<NullSink>();
+    }
+    switch (channel) {
+    case OutputChannel::Console:
+        m_consoleSink = std::move(sink);
+        break;
+    case OutputChannel::Log:
+        m_logSink = std::move(sink);
+        break;
+    case OutputChannel::Error:
+        m_errorSink = std::move(sink);
+        break;
     }
 }
 
@@ -62,22 +174,133 @@ TrafficSim::~TrafficSim()
 // ----------------------------------------------------------------
 bool TrafficSim::initialize(const std::string &configPath)
 {
-    if (!loadConfig(configPath)) {
+    std::ifstream inFile(configPath);
+    if (!inFile.is_open()) {
+        reportError("[Error] Could not open config file: " + configPath + "\n");
         return false;
     }
+    return initialize(inFile);
+}
 
-    // Create intersections
-    for (int i = 1; i <= m_numIntersections; ++i) {
-        Intersection inter(i);
+bool TrafficSim::initialize(std::istream &config)
+{
+    // A simulation can be initialized again for a new run; nothing of the old config may leak
+    resetConfig();
+    if (!loadConfig(config)) {
+        reportError("[Error] Invalid or incomplete simulation config.\n");
+        return false;
+    }
+
+    // Reuse the intersections of a previous run and only construct the missing ones
+    if (static_cast<int>(m_intersections.size()) > m_numIntersections) {
+        m_intersections.erase(m_intersections.begin() + m_numIntersections, m_intersections.end());
+    }
+    for (Intersection &inter : m_intersections) {
+        inter.reset();
+    }
+    m_intersections.reserve(m_numIntersections);
+    for (int i = static_cast<int>(m_intersections.size()) + 1; i <= m_numIntersections; ++i) {
+        m_intersections.push_back(Intersection(i));
+    }
+    for (Intersection &inter : m_intersections) {
         // If you want to set per-intersection times from config:
         inter.setLightTimes(m_greenTime, m_redTime);
-        m_intersections.insert({ i, std::move(inter) });
+        inter.setKinematics(m_laneLength, m_stepSeconds, m_subSteps);
+    }
+
+    // Vehicles and per-run records are cleared in place so their storage is kept
+    m_vehicles.clear();
+    m_simHistory.clear();
+    m_stepSpawns.clear();
+    m_changedIndices.clear();
+    m_currentStep = 0;
+    if (m_hasSeed) {
+        m_rng.seed(m_seed);
     }
 
-    // Open log file
-    m_logFile.open("logs/simulation_log.txt", std::ios::out);
-    if (!m_logFile.is_open()) {
-        std::cerr << "[Error] Could not open simulation_log.txt for writing.\n";
+    // Hot-spot rankings start with every counter at zero
+    m_busiest.reset(m_numIntersections);
+    m_congested.reset(m_numIntersections);
+    m_networkWaiting = 0;
+    m_networkThroughput = 0;
+    m_networkPassed = 0;
+    m_spinnerFrame = 0;
+
+    // Mirrors the pipeline stages patch with sparse snapshots start from the reset state
+    m_historyStates.clear();
+    for (const Intersection &inter : m_intersections) {
+        m_historyStates.push_back(snapshotOf(inter));
+    }
+    m_rankedStates = m_historyStates;
+
+    // Road grid and routing; every run starts from free-flow costs and an empty route cache
+    m_network.buildGrid(m_numIntersections, m_laneLength / kFreeFlowSpeed);
+    for (const Incident &incident : m_incidents) {
+        bool known = incident.from >= 1 && incident.from <= m_numIntersections
+                  && (incident.to == 0 || m_network.findLink(incident.from - 1, incident.to - 1) >= 0);
+        if (!known) {
+            reportError("[Error] Incident at step " + std::to_string(incident.startStep)
+                        + " refers to an unknown intersection or road.\n");
+            return false;
+        }
+        // Without routing vehicles never use roads, so a road closure would have no effect
+        if (incident.to != 0 && !m_routing) {
+            reportError("[Error] Incident at step " + std::to_string(incident.startStep)
+                        + " closes a road, which requires routing = 1.\n");
+            return false;
+        }
+    }
+    m_nodeClosures.assign(m_numIntersections, 0);
+    m_linkClosures.assign(m_network.linkCount(), 0);
+    if (m_routing) {
+        m_router.reset(&m_network, m_routingThreads);
+    } else {
+        m_router.stop();
+    }
+    m_reportedDelay.assign(m_numIntersections, 0.0);
+    m_destinationChanged.assign(m_numIntersections, 0);
+    m_transfers.clear();
+    m_stepEvents.clear();
+
+    // Two series per intersection: vehicles passed per step and vehicles waiting
+    m_stopReason = StopReason::Running;
+    if (m_steadyStateDetection) {
+        m_steadyState.configure(kNetworkSeries + 2 * m_numIntersections, kNetworkSeries, m_steadyStateBatchSize,
+                                m_steadyStateMinBatches, m_steadyStateTolerance);
+    }
+
+    // Sampling profiler (optional); a fresh buffer per run
+#ifdef TRAFFICSIM_HAS_PROFILER
+    m_profiler.reset();
+    if (!m_profilerOutput.empty()) {
+        m_profiler.reset(new SamplingProfiler(kProfilerSamples));
+    }
+#else
+    if (!m_profilerOutput.empty()) {
+        reportError("[Error] profiler_output needs the sampling profiler, which is not available on this platform.\n");
+        return false;
+    }
+#endif
+
+    // Allocation tracking (optional); step windows are measured from here
+    m_allocationTracking = m_allocationReport || m_allocationBudget >= 0;
+    if (m_allocationTracking && !AllocationTracker::available()) {
+        reportError("[Error] allocation_report and allocation_budget need a build configured with -DTRAFFICSIM_ALLOC_TRACKING=ON.\n");
+        return false;
+    }
+    m_allocationBudgetViolations = 0;
+    if (m_allocationTracking) {
+        AllocationTracker::resetPeak();
+        AllocationTracker::snapshot(m_allocationStart);
+        m_allocationMark = m_allocationStart;
+        m_allocationPeak = m_allocationStart.peakBytes;
+    }
+
+    // Load demand profile (optional)
+    std::string error;
+    m_demand.clear();
+    if (!m_demandProfilePath.empty() && !m_demand.load(m_demandProfilePath, m_numIntersections, error)) {
+        reportError(error);
         return false;
     }
 
@@ -85,93 +308,385 @@ bool TrafficSim::initialize(const std::string &configPath)
     return true;
 }
 
-bool TrafficSim::loadConfig(const std::string &path)
+void TrafficSim::resetConfig()
 {
-    std::ifstream inFile(path);
-    if (!inFile.is_open()) {
-        std::cerr << "[Error] Could not open config file: " << path << "\n";
-        return false;
-    }
+    m_numIntersections = 0;
+    m_vehiclesPerStep = 0;
+    m_maxSteps = 0;
+    m_greenTime = 3;
+    m_redTime = 2;
+    m_laneLength = 200.0;
+    m_stepSeconds = 1.0;
+    m_subSteps = 10;
+    m_frameDelayMs = 800;
+    m_dashboardTopK = 0;
+    m_demandProfilePath.clear();
+    m_routing = false;
+    m_routingThreads = 1;
+    m_routeCostThreshold = 0.25;
+    m_incidents.clear();
+    m_steadyStateDetection = false;
+    m_steadyStateTolerance = 0.05;
+    m_steadyStateBatchSize = 5;
+    m_steadyStateMinBatches = 10;
+    m_profilerOutput.clear();
+    m_profilerHz = 99;
+    m_allocationReport = false;
+    m_allocationBudget = -1;
+    m_hasSeed = false;
+    m_seed = 0;
+}
 
+bool TrafficSim::loadConfig(std::istream &in)
+{
+    bool valid = true;
     std::string line;
-    while (std::getline(inFile, line))
+    while (std::getline(in, line))
     {
-        if (line.find("intersections") != std::string::npos) {
-            m_numIntersections = std::stoi(line.substr(line.find("=") + 1));
+        // Keys are compared exactly, so a value (e.g. a path) can never be taken for another key
+        std::size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            continue;
+        }
+        const std::string key = trim(line.substr(0, equals));
+        const std::string value = line.substr(equals + 1);
+
+        bool ok = true;
+        if (key == "incident") {
+            // incident = <start step> <duration> intersection <id>
+            // incident = <start step> <duration> link <from id> <to id>
+            std::istringstream fields(value);
+            Incident incident{ 0, 0, 0, 0 };
+            std::string kind;
+            fields >> incident.startStep >> incident.duration >> kind >> incident.from;
+            if (kind == "link") {
+                fields >> incident.to;
+            }
+            ok = fields && (kind == "intersection" || kind == "link") && incident.startStep >= 1 && incident.duration >= 1;
+            if (ok) {
+                m_incidents.push_back(incident);
+            }
+        }
+        else if (key == "intersections") {
+            ok = readValue(value, m_numIntersections);
+        }
+        else if (key == "vehicles_per_step") {
+            ok = readValue(value, m_vehiclesPerStep);
+        }
+        else if (key == "max_simulation_steps") {
+            ok = readValue(value, m_maxSteps);
+        }
+        else if (key == "traffic_light_green_time") {
+            ok = readValue(value, m_greenTime);
+        }
+        else if (key == "traffic_light_red_time") {
+            ok = readValue(value, m_redTime);
+        }
+        else if (key == "lane_length") {
+            ok = readValue(value, m_laneLength);
+        }
+        else if (key == "step_duration") {
+            ok = readValue(value, m_stepSeconds);
+        }
+        else if (key == "kinematic_sub_steps") {
+            ok = readValue(value, m_subSteps);
+        }
+        else if (key == "frame_delay_ms") {
+            ok = readValue(value, m_frameDelayMs);
+        }
+        else if (key == "dashboard_top_k") {
+            ok = readValue(value, m_dashboardTopK);
+        }
+        else if (key == "random_seed") {
+            ok = readValue(value, m_seed);
+            m_hasSeed = m_hasSeed || ok;
         }
-        else if (line.find("vehicles_per_step") != std::string::npos) {
-            m_vehiclesPerStep = std::stoi(line.substr(line.find("=") + 1));
+        else if (key == "demand_profile") {
+            ok = readValue(value, m_demandProfilePath);
         }
-        else if (line.find("max_simulation_steps") != std::string::npos) {
-            m_maxSteps = std::stoi(line.substr(line.find("=") + 1));
+        else if (key == "steady_state") {
+            ok = readFlag(value, m_steadyStateDetection);
         }
-        else if (line.find("traffic_light_green_time") != std::string::npos) {
-            m_greenTime = std::stoi(line.substr(line.find("=") + 1));
+        else if (key == "steady_state_tolerance") {
+            ok = readValue(value, m_steadyStateTolerance);
         }
-        else if (line.find("traffic_light_red_time") != std::string::npos) {
-            m_redTime = std::stoi(line.substr(line.find("=") + 1));
+        else if (key == "steady_state_batch_size") {
+            ok = readValue(value, m_steadyStateBatchSize);
+        }
+        else if (key == "steady_state_min_batches") {
+            ok = readValue(value, m_steadyStateMinBatches);
+        }
+        else if (key == "profiler_output") {
+            ok = readValue(value, m_profilerOutput);
+        }
+        else if (key == "profiler_hz") {
+            ok = readValue(value, m_profilerHz);
+        }
+        else if (key == "allocation_report") {
+            ok = readFlag(value, m_allocationReport);
+        }
+        else if (key == "allocation_budget") {
+            ok = readValue(value, m_allocationBudget);
+        }
+        else if (key == "routing") {
+            ok = readFlag(value, m_routing);
+        }
+        else if (key == "routing_threads") {
+            ok = readValue(value, m_routingThreads);
+        }
+        else if (key == "route_cost_threshold") {
+            ok = readValue(value, m_routeCostThreshold);
+        }
+        if (!ok) {
+            reportError("[Error] Invalid config line: " + line + "\n");
+            valid = false;
         }
     }
-    inFile.close();
 
-    return (m_numIntersections > 0 && m_vehiclesPerStep >= 0 && m_maxSteps > 0);
+    return (valid && m_numIntersections > 0 && m_vehiclesPerStep >= 0 && m_maxSteps > 0
+            && m_greenTime > 0 && m_redTime > 0 && m_laneLength > 0.0 && m_stepSeconds > 0.0 && m_subSteps > 0
+            && m_routingThreads > 0 && m_routeCostThreshold >= 0.0
+            && m_steadyStateTolerance > 0.0 && m_steadyStateBatchSize > 0 && m_steadyStateMinBatches > 0
+            && m_profilerHz > 0 && m_allocationBudget >= -1);
 }
 
 void TrafficSim::logMessage(const std::string &message)
 {
-    if (m_logFile.is_open()) {
-        m_logFile << message;
-    }
+    m_logSink->write(message);
+}
+
+void TrafficSim::reportError(const std::string &message)
+{
+    m_errorSink->write(message);
 }
 
 // ----------------------------------------------------------------
-//   spawnVehicles (basic version)
+//   spawnVehicles
 // ----------------------------------------------------------------
 void TrafficSim::spawnVehicles()
 {
-    for (int i = 0; i < m_vehiclesPerStep; ++i) {
-        int vehicleId = m_rng.randomInt(100, 999);
+    AllocationScope phase(AllocationPhase::Spawn);
+
+    // Demand profile windows are optional; uncovered steps use the flat config rate
+    bool profiled = m_demand.activate(m_currentStep);
+    int arrivals = profiled ? m_demand.sampleArrivals(m_rng) : m_vehiclesPerStep;
+
+    for (int i = 0; i < arrivals; ++i) {
         double speed = m_rng.randomDouble(20.0, 80.0);
 
-        // 50% chance for Car, 50% for Truck
-        if (m_rng.randomInt(0, 1) == 0) {
-            auto car = std::make_unique<Car>(vehicleId, speed);
-            int interId = m_rng.randomInt(1, m_numIntersections);
-            m_intersections.at(interId).addVehicle(std::move(car));
-            logMessage("[Step " + std::to_string(m_currentStep) + "] Car spawned at intersection " + std::to_string(interId) + ".\n");
+        VehicleType type;
+        if (profiled) {
+            type = m_demand.sampleVehicleType(m_rng);
+        } else {
+            // 50% chance for Car, 50% for Truck
+            type = (m_rng.randomInt(0, 1) == 0) ? VehicleType::Car : VehicleType::Truck;
+        }
+        int interId = profiled ? m_demand.sampleIntersection(m_rng)
+                               : m_rng.randomInt(1, m_numIntersections);
+
+        // Routed vehicles drive to a destination drawn like an origin, but never the origin itself
+        int destination = 0;
+        if (m_routing && m_numIntersections > 1) {
+            for (int draw = 0; draw < kDestinationDraws && (destination == 0 || destination == interId); ++draw) {
+                destination = profiled ? m_demand.sampleIntersection(m_rng)
+                                       : m_rng.randomInt(1, m_numIntersections);
+            }
+            if (destination == interId) {
+                destination = 0;
+            }
+        }
+
+        VehicleHandle handle = (type == VehicleType::Car) ? m_vehicles.spawn<Car>(speed)
+                                                          : m_vehicles.spawn<Truck>(speed);
+        Vehicle *vehicle = m_vehicles.get(handle);
+        vehicle->setDestination(destination);
+        vehicle->setNextHop(routeFrom(interId, destination));
+        admitVehicle(interId, handle, *vehicle);
+        m_stepSpawns.push_back(SpawnRecord{ m_currentStep, vehicle->getId(),
+                                            type == VehicleType::Car ? "Car" : "Truck", interId, destination });
+    }
+}
+
+// ----------------------------------------------------------------
+//   Incidents & routing
+// ----------------------------------------------------------------
+void TrafficSim::applyIncidents()
+{
+    // Start before clearing, so back-to-back incidents on one place keep it closed without a blip
+    for (const Incident &incident : m_incidents) {
+        if (incident.startStep == m_currentStep) {
+            setIncident(incident, true);
+        }
+    }
+    for (const Incident &incident : m_incidents) {
+        if (incident.startStep + incident.duration == m_currentStep) {
+            setIncident(incident, false);
+        }
+    }
+}
+
+void TrafficSim::setIncident(const Incident &incident, bool closed)
+{
+    // Incidents may overlap: a place only reopens once the last incident covering it clears
+    const int delta = closed ? 1 : -1;
+    const char *state = closed ? " closed." : " reopened.";
+    if (incident.to == 0) {
+        int &count = m_nodeClosures[incident.from - 1];
+        count += delta;
+        if (count == (closed ? 1 : 0)) {
+            m_intersections[incident.from - 1].setClosed(closed);
+            if (m_routing) {
+                m_router.setNodeClosed(incident.from - 1, closed);
+            }
+            m_stepEvents.push_back("Intersection " + std::to_string(incident.from) + state);
+        }
+        return;
+    }
+
+    // A road closure blocks both directions; "7 8" and "8 7" share the count of the lower-to-higher link
+    const int low = std::min(incident.from, incident.to) - 1;
+    const int high = std::max(incident.from, incident.to) - 1;
+    int forward = m_network.findLink(low, high);
+    int backward = m_network.findLink(high, low);
+    int &count = m_linkClosures[forward];
+    count += delta;
+    if (count == (closed ? 1 : 0)) {
+        m_router.setLinkClosed(forward, closed);
+        m_router.setLinkClosed(backward, closed);
+        m_stepEvents.push_back("Road " + std::to_string(incident.from) + "-" + std::to_string(incident.to) + state);
+    }
+}
+
+void TrafficSim::rerouteAffected()
+{
+    AllocationScope phase(AllocationPhase::Routing);
+    if (!m_router.sync(m_routeChanges)) {
+        return;
+    }
+
+    // Group the changes by intersection so every queue is scanned once, however many of its
+    // destinations changed
+    std::sort(m_routeChanges.begin(), m_routeChanges.end());
+    int rerouted = 0;
+    std::size_t begin = 0;
+    while (begin < m_routeChanges.size())
+    {
+        int node = m_routeChanges[begin].first;
+        std::size_t end = begin;
+        for (; end < m_routeChanges.size() && m_routeChanges[end].first == node; ++end) {
+            m_destinationChanged[m_routeChanges[end].second] = 1;
+        }
+
+        for (const VehicleHandle &handle : m_intersections[node].getQueuedVehicles())
+        {
+            Vehicle *vehicle = m_vehicles.get(handle);
+            int destination = vehicle->getDestination();
+            if (destination == 0 || !m_destinationChanged[destination - 1]) {
+                continue;
+            }
+            int hop = routeFrom(node + 1, destination);
+            if (hop != vehicle->getNextHop()) {
+                vehicle->setNextHop(hop);
+                ++rerouted;
+            }
+        }
+
+        for (; begin < end; ++begin) {
+            m_destinationChanged[m_routeChanges[begin].second] = 0;
+        }
+    }
+    if (rerouted > 0) {
+        m_stepEvents.push_back("Re-routed " + std::to_string(rerouted) + " vehicles.");
+    }
+}
+
+void TrafficSim::releaseExited(const Intersection &inter)
+{
+    for (const VehicleHandle &handle : inter.getExited())
+    {
+        int hop = m_routing ? m_vehicles.get(handle)->getNextHop() : 0;
+        if (hop != 0) {
+            m_transfers.push_back(Transfer{ handle, hop });
         } else {
-            auto truck = std::make_unique<Truck>(vehicleId, speed);
-            int interId = m_rng.randomInt(1, m_numIntersections);
-            m_intersections.at(interId).addVehicle(std::move(truck));
-            logMessage("[Step " + std::to_string(m_currentStep) + "] Truck spawned at intersection " + std::to_string(interId) + ".\n");
+            m_vehicles.remove(handle);
         }
     }
 }
 
+void TrafficSim::applyTransfers()
+{
+    for (const Transfer &transfer : m_transfers)
+    {
+        Vehicle *vehicle = m_vehicles.get(transfer.handle);
+        admitVehicle(transfer.to, transfer.handle, *vehicle);
+        vehicle->setNextHop(routeFrom(transfer.to, vehicle->getDestination()));
+    }
+    m_transfers.clear();
+}
+
+void TrafficSim::updateRouteCosts()
+{
+    AllocationScope phase(AllocationPhase::Routing);
+
+    // Expected wait = queue length times the time each queued vehicle needs, stretched by red time
+    double cycle = static_cast<double>(m_greenTime + m_redTime);
+    double perVehicle = kSaturationHeadway * (m_greenTime > 0 ? cycle / m_greenTime : 1.0);
+    double floor = m_laneLength / kFreeFlowSpeed;
+
+    for (int i = 0; i < m_numIntersections; ++i)
+    {
+        double delay = m_intersections[i].getWaitingCount() * perVehicle;
+        double &reported = m_reportedDelay[i];
+        if (std::fabs(delay - reported) > m_routeCostThreshold * std::max(reported, floor)) {
+            m_router.setNodeDelay(i, delay);
+            reported = delay;
+        }
+    }
+}
+
+void TrafficSim::admitVehicle(int interId, VehicleHandle handle, const Vehicle &vehicle)
+{
+    Intersection &inter = m_intersections[interId - 1];
+    if (!inter.hasChanged()) {
+        m_changedIndices.push_back(interId - 1);
+    }
+    inter.addVehicle(handle, vehicle);
+}
+
+int TrafficSim::routeFrom(int interId, int destination)
+{
+    if (!m_routing || destination == 0 || destination == interId) {
+        return 0;
+    }
+    // A destination seen for the first time has its tree solved right here
+    AllocationScope phase(AllocationPhase::Routing);
+    return m_router.nextHop(interId - 1, destination - 1) + 1;
+}
+
 // ----------------------------------------------------------------
 //   The "Cool" Printing Functions
 // ----------------------------------------------------------------
 
+using IntersectionRecord = TrafficSim::IntersectionRecord;
+
 // 1) ASCII Map
-static void printAsciiMap(const std::map<int, Intersection> &intersections)
+static void printAsciiMap(std::ostream &os, const std::vector<IntersectionRecord> &intersections)
 {
-    std::cout << "[ASCII Map]\n";
+    os << "[ASCII Map]\n";
 
     std::ostringstream topLine;
     std::ostringstream botLine;
 
     // We’ll just place them in a row: (I1)---- (I2)---- etc.
-    for (auto &kv : intersections)
+    for (const IntersectionRecord &inter : intersections)
     {
-        const Intersection &inter = kv.second;
-
         // Red or Green label
-        bool g = inter.isGreen();
+        bool g = inter.isGreen;
         const char *color = g ? ANSI_GREEN : ANSI_RED;
-        topLine << color << "(I" << inter.getId() << ")" << ANSI_RESET << "----- ";
+        topLine << color << "(I" << inter.id << ")" << ANSI_RESET << "----- ";
 
         // Vehicles in waiting queue
-        int waiting = inter.getWaitingCount();
+        int waiting = inter.waitingCount;
         if (waiting > 0)
         {
             std::string vehicles;
@@ -179,53 +694,51 @@ static void printAsciiMap(const std::map<int, Intersection> &intersections)
             {
                 vehicles += "V ";
             }
-            botLine << "I" << inter.getId() << ": " << vehicles << "   ";
+            botLine << "I" << inter.id << ": " << vehicles << "   ";
         }
         else
         {
-            botLine << "I" << inter.getId() << ": (empty)   ";
+            botLine << "I" << inter.id << ": (empty)   ";
         }
     }
 
-    std::cout << topLine.str() << "\n"
-              << botLine.str() << "\n\n";
+    os << topLine.str() << "\n"
+       << botLine.str() << "\n\n";
 }
 
 // 2) Intersections Table
-static void printIntersectionsTable(const std::map<int, Intersection> &intersections)
+static void printIntersectionsTable(std::ostream &os, const std::vector<IntersectionRecord> &intersections)
 {
-    std::cout << "ID | Status | Waiting | PassedThisStep | Throughput\n";
-    std::cout << "---+--------+---------+----------------+-----------\n";
+    os << "ID | Status | Waiting | PassedThisStep | Throughput\n";
+    os << "---+--------+---------+----------------+-----------\n";
 
-    for (auto &kv : intersections)
+    for (const IntersectionRecord &inter : intersections)
     {
-        const Intersection &inter = kv.second;
-
-        bool g = inter.isGreen();
+        bool g = inter.isGreen;
         const char *color = g ? ANSI_GREEN : ANSI_RED;
         std::string colorStr = g ? "GREEN " : "RED   ";
 
-        std::cout << inter.getId() << "  | "
-                  << color << colorStr << ANSI_RESET << " | "
-                  << inter.getWaitingCount() << "       | "
-                  << inter.getPassedThisStep() << "              | "
-                  << inter.getThroughput() << "\n";
+        os << inter.id << "  | "
+           << color << colorStr << ANSI_RESET << " | "
+           << inter.waitingCount << "       | "
+           << inter.passedThisStep << "              | "
+           << inter.totalThroughput << "\n";
     }
-    std::cout << "\n";
+    os << "\n";
 }
 
 // 3) Throughput Bar Chart
-static void printThroughputBars(const std::map<int, Intersection> &intersections)
+static void printThroughputBars(std::ostream &os, const std::vector<IntersectionRecord> &intersections)
 {
-    std::cout << "[Throughput Bar Chart]\n";
+    os << "[Throughput Bar Chart]\n";
 
     // Find max
     int maxThroughput = 0;
-    for (auto &kv : intersections)
+    for (const IntersectionRecord &inter : intersections)
     {
-        if (kv.second.getThroughput() > maxThroughput)
+        if (inter.totalThroughput > maxThroughput)
         {
-            maxThroughput = kv.second.getThroughput();
+            maxThroughput = inter.totalThroughput;
         }
     }
     if (maxThroughput == 0)
@@ -234,10 +747,9 @@ static void printThroughputBars(const std::map<int, Intersection> &intersections
     }
 
     int maxBarWidth = 30;
-    for (auto &kv : intersections)
+    for (const IntersectionRecord &inter : intersections)
     {
-        const Intersection &inter = kv.second;
-        int th = inter.getThroughput();
+        int th = inter.totalThroughput;
 
         int barLength = static_cast<int>((double)th / maxThroughput * maxBarWidth);
         const char *color = ANSI_GREEN;
@@ -251,60 +763,495 @@ static void printThroughputBars(const std::map<int, Intersection> &intersections
         }
 
         std::string bar = repeatChar('#', barLength);
-        std::cout << "Intersection " << inter.getId() << ": "
-                  << color << bar << ANSI_RESET
-                  << " (" << th << ")\n";
+        os << "Intersection " << inter.id << ": "
+           << color << bar << ANSI_RESET
+           << " (" << th << ")\n";
     }
-    std::cout << "\n";
+    os << "\n";
 }
 
 // ----------------------------------------------------------------
-//   runSimulation
+//   Steady-state detection
 // ----------------------------------------------------------------
-void TrafficSim::runSimulation()
+void TrafficSim::observeSteadyState()
 {
-    std::cout << "\nStarting TrafficSim Simulation...\n";
+    AllocationScope phase(AllocationPhase::Statistics);
 
-    for (m_currentStep = 1; m_currentStep <= m_maxSteps; ++m_currentStep)
+    // Network totals come first: they choose the warm-up cut, averaged over every intersection
+    int passed = 0;
+    int waiting = 0;
+    for (int i = 0; i < m_numIntersections; ++i)
     {
-        // 1) Spawn new vehicles
-        spawnVehicles();
+        const Intersection &inter = m_intersections[i];
+        passed += inter.getPassedThisStep();
+        waiting += inter.getWaitingCount();
+        m_steadyState.record(kNetworkSeries + 2 * i, inter.getPassedThisStep());
+        m_steadyState.record(kNetworkSeries + 2 * i + 1, inter.getWaitingCount());
+    }
+    m_steadyState.record(0, passed);
+    m_steadyState.record(1, waiting);
+
+    if (m_steadyState.endStep()) {
+        m_stopReason = StopReason::SteadyState;
+        int warmup = m_steadyState.warmupSteps();
+        m_stepEvents.push_back(warmup > 0 ? "Steady state reached; warm-up cut after step " + std::to_string(warmup) + "."
+                                          : std::string("Steady state reached; no warm-up cut."));
+    }
+}
+
+// ----------------------------------------------------------------
+//   Allocation tracking
+// ----------------------------------------------------------------
+void TrafficSim::measureAllocations(StepRecord &record)
+{
+    if (!m_allocationTracking) {
+        record.allocations = AllocationSnapshot();
+        return;
+    }
+
+    // The window runs from the start of the step to its publication and covers only this
+    // simulation's threads, so other simulations in the process never show up in it. Pipeline
+    // stages still working on the previous step do, which is why only the simulation thread's own
+    // phases count against the budget.
+    AllocationSnapshot now;
+    AllocationTracker::snapshot(m_allocationBlocks.data(), m_allocationBlocks.size(), now);
+    AllocationTracker::difference(now, m_stepAllocationMark, record.allocations);
 
-        // 2) Update each intersection
-        for (auto &kv : m_intersections)
+    // Run totals and peak heap are process-wide and only reported
+    AllocationTracker::snapshot(m_allocationMark);
+    m_allocationPeak = std::max(m_allocationPeak, m_allocationMark.peakBytes);
+    AllocationTracker::resetPeak();
+
+    if (m_allocationBudget >= 0 && record.allocations.simulationAllocations() > static_cast<std::uint64_t>(m_allocationBudget)) {
+        ++m_allocationBudgetViolations;
+    }
+}
+
+void TrafficSim::writeAllocationSummary(std::ostream &out) const
+{
+    AllocationSnapshot run;
+    AllocationTracker::difference(m_allocationMark, m_allocationStart, run);
+
+    out << "Allocation budget: ";
+    if (m_allocationBudget >= 0) {
+        out << m_allocationBudget << " per step, exceeded in " << m_allocationBudgetViolations
+            << " of " << m_currentStep << " steps\n";
+    } else {
+        out << "none\n";
+    }
+    out << "Peak heap: " << m_allocationPeak << " bytes | Live at last step: " << run.liveBytes << " bytes\n"
+        << "Phase | Allocations | Bytes | Frees | Freed bytes | Allocations/step\n";
+    for (int p = 0; p < static_cast<int>(AllocationPhase::Count); ++p)
+    {
+        const AllocationStats &stats = run.phases[p];
+        out << AllocationTracker::phaseName(static_cast<AllocationPhase>(p)) << " | " << stats.allocations
+            << " | " << stats.allocatedBytes << " | " << stats.frees << " | " << stats.freedBytes
+            << " | " << (m_currentStep > 0 ? static_cast<double>(stats.allocations) / m_currentStep : 0.0) << "\n";
+    }
+    out << "total | " << run.totalAllocations() << " | " << run.totalAllocatedBytes() << " | - | - | "
+        << (m_currentStep > 0 ? static_cast<double>(run.totalAllocations()) / m_currentStep : 0.0) << "\n";
+}
+
+// ----------------------------------------------------------------
+//   Pipeline stages: statistics, logging, rendering
+// ----------------------------------------------------------------
+void TrafficSim::publishStep()
+{
+    AllocationScope phase(AllocationPhase::Publish);
+    StepRecord &record = m_pipeline.acquire();
+    record.stepNumber = m_currentStep;
+    record.sparse = m_sparseSnapshots;
+
+    record.intersectionStates.clear();
+    record.changedIntersections.clear();
+    if (record.sparse) {
+        // Only what changed; the stages patch their mirrors with it
+        for (int index : m_changedIndices)
         {
-            kv.second.update();
+            Intersection &inter = m_intersections[index];
+            record.changedIntersections.push_back(index);
+            record.intersectionStates.push_back(snapshotOf(inter));
+            inter.clearChanged();
         }
+    } else {
+        for (Intersection &inter : m_intersections)
+        {
+            if (inter.hasChanged()) {
+                record.changedIntersections.push_back(static_cast<int>(record.intersectionStates.size()));
+                inter.clearChanged();
+            }
+            record.intersectionStates.push_back(snapshotOf(inter));
+        }
+    }
+    m_changedIndices.clear();
 
-        // 3) Fancy display
-        std::cout << ANSI_CLEAR_SCREEN;
-        std::cout << "=== TrafficSimCPP Live Dashboard ===\n\n";
+    // Swap so the vectors keep their capacity from step to step
+    record.spawnedVehicles.swap(m_stepSpawns);
+    m_stepSpawns.clear();
+    record.events.swap(m_stepEvents);
+    m_stepEvents.clear();
+
+    measureAllocations(record);
+    m_pipeline.publish();
+}
+
+void TrafficSim::recordStepData(const StepRecord &record)
+{
+    AllocationScope phase(AllocationPhase::Statistics);
+    if (record.sparse) {
+        for (std::size_t k = 0; k < record.changedIntersections.size(); ++k) {
+            m_historyStates[record.changedIntersections[k]] = record.intersectionStates[k];
+        }
+    } else {
+        m_historyStates = record.intersectionStates;
+    }
+    if (!m_recordHistory) {
+        return;
+    }
+
+    // History records are always dense; sparse records do not carry light toggles
+    m_simHistory.push_back(StepRecord());
+    StepRecord &entry = m_simHistory.back();
+    entry.stepNumber = record.stepNumber;
+    entry.sparse = false;
+    entry.intersectionStates = m_historyStates;
+    if (record.sparse) {
+        const bool green = Intersection::isGreenAfter(m_greenTime, m_redTime, record.stepNumber);
+        for (IntersectionRecord &state : entry.intersectionStates) {
+            state.isGreen = green;
+        }
+    }
+    entry.spawnedVehicles = record.spawnedVehicles;
+    entry.changedIntersections = record.changedIntersections;
+    entry.events = record.events;
+    entry.allocations = record.allocations;
+}
+
+void TrafficSim::logStepData(const StepRecord &record)
+{
+    AllocationScope phase(AllocationPhase::Logging);
+    if (!m_logSink->enabled()) {
+        return;
+    }
+    for (const SpawnRecord &spawn : record.spawnedVehicles)
+    {
+        std::string trip = spawn.destination != 0 ? " heading to " + std::to_string(spawn.destination) : "";
+        logMessage("[Step " + std::to_string(spawn.stepNumber) + "] " + spawn.vehicleType + " #" + std::to_string(spawn.vehicleId)
+                   + " spawned at intersection " + std::to_string(spawn.intersectionAssigned) + trip + ".\n");
+    }
+    for (const std::string &event : record.events)
+    {
+        logMessage("[Step " + std::to_string(record.stepNumber) + "] " + event + "\n");
+    }
+    logMessage("[Step " + std::to_string(record.stepNumber) + "] Updated intersections.\n");
+
+    // Allocation counts are taken on the simulation thread; only the formatting happens here
+    if (!m_allocationTracking) {
+        return;
+    }
+    const AllocationSnapshot &alloc = record.allocations;
+    std::uint64_t total = alloc.totalAllocations();
+    if (m_allocationReport) {
+        std::string line = "[Step " + std::to_string(record.stepNumber) + "] Allocations: " + std::to_string(total)
+                         + " (" + std::to_string(alloc.totalAllocatedBytes()) + " bytes)";
+        const char *separator = ": ";
+        for (int p = 0; p < static_cast<int>(AllocationPhase::Count); ++p)
+        {
+            if (alloc.phases[p].allocations > 0) {
+                line += separator;
+                line += AllocationTracker::phaseName(static_cast<AllocationPhase>(p));
+                line += " " + std::to_string(alloc.phases[p].allocations);
+                separator = ", ";
+            }
+        }
+        logMessage(line + "; live " + std::to_string(alloc.liveBytes) + " bytes, peak "
+                   + std::to_string(alloc.peakBytes) + " bytes.\n");
+    }
+    std::uint64_t budgeted = alloc.simulationAllocations();
+    if (m_allocationBudget >= 0 && budgeted > static_cast<std::uint64_t>(m_allocationBudget)) {
+        logMessage("[Step " + std::to_string(record.stepNumber) + "] Allocation budget exceeded: "
+                   + std::to_string(budgeted) + " simulation-thread allocations > " + std::to_string(m_allocationBudget) + ".\n");
+    }
+}
+
+void TrafficSim::renderStep(const StepRecord &record)
+{
+    AllocationScope phase(AllocationPhase::Rendering);
+
+    // Rankings must see every step, even the ones that are not drawn
+    if (m_dashboardTopK > 0) {
+        updateRankings(record);
+    }
+
+    // Nobody is watching: skip formatting and pacing entirely
+    if (!m_consoleSink->enabled()) {
+        return;
+    }
+
+    m_frame.str("");
+    m_frame.clear();
+
+    if (m_dashboardTopK > 0) {
+        renderTopK(record);
+    } else {
+        m_frame << ANSI_CLEAR_SCREEN;
+        m_frame << "=== TrafficSimCPP Live Dashboard ===\n\n";
 
         // Spinner
-        printSpinner(m_currentStep, m_maxSteps);
-        std::cout << "\n";
+        printSpinner(m_frame, record.stepNumber, m_maxSteps, m_spinnerFrame);
+        m_frame << "\n";
 
         // ASCII map
-        printAsciiMap(m_intersections);
+        printAsciiMap(m_frame, record.intersectionStates);
 
         // Intersections table
-        printIntersectionsTable(m_intersections);
+        printIntersectionsTable(m_frame, record.intersectionStates);
 
         // Throughput bars
-        printThroughputBars(m_intersections);
+        printThroughputBars(m_frame, record.intersectionStates);
+    }
+    m_consoleSink->write(m_frame.str());
 
-        // Log step info
-        logMessage("[Step " + std::to_string(m_currentStep) + "] Updated intersections.\n");
+    // Delay so the updates are visible
+    if (m_frameDelayMs > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(m_frameDelayMs));
+    }
+}
 
-        // Delay so the updates are visible
-        std::this_thread::sleep_for(std::chrono::milliseconds(800));
+void TrafficSim::updateRankings(const StepRecord &record)
+{
+    // Re-rank only what moved; the heaps still hold last frame's values for the deltas
+    m_networkPassed = 0;
+    for (std::size_t k = 0; k < record.changedIntersections.size(); ++k)
+    {
+        int index = record.changedIntersections[k];
+        const IntersectionRecord &inter = record.sparse ? record.intersectionStates[k] : record.intersectionStates[index];
+        m_rankedStates[index] = inter;
+        m_networkWaiting += inter.waitingCount - m_congested.priority(index);
+        m_networkThroughput += inter.totalThroughput - m_busiest.priority(index);
+        m_networkPassed += inter.passedThisStep;
+
+        m_congested.update(index, inter.waitingCount);
+        m_busiest.update(index, inter.totalThroughput);
+    }
+}
+
+void TrafficSim::renderTopK(const StepRecord &record)
+{
+    m_frame << ANSI_CLEAR_SCREEN;
+    m_frame << "=== TrafficSimCPP Hot-Spot Dashboard ===\n\n";
+
+    printSpinner(m_frame, record.stepNumber, m_maxSteps, m_spinnerFrame);
+    m_frame << "\n";
+
+    m_frame << "[Network] Intersections: " << m_rankedStates.size()
+            << " | Waiting: " << m_networkWaiting
+            << " | Passed this step: " << m_networkPassed
+            << " | Throughput: " << m_networkThroughput << "\n\n";
+
+    // Light toggles are not published; every light shows the shared schedule's state
+    const bool green = Intersection::isGreenAfter(m_greenTime, m_redTime, record.stepNumber);
+
+    m_busiest.top(m_dashboardTopK, m_topKeys);
+    m_topRecords.clear();
+    for (int index : m_topKeys)
+    {
+        m_topRecords.push_back(m_rankedStates[index]);
+        m_topRecords.back().isGreen = green;
+    }
+    m_frame << "[Top " << m_dashboardTopK << " Busiest]\n";
+    printThroughputBars(m_frame, m_topRecords);
+
+    m_congested.top(m_dashboardTopK, m_topKeys);
+    m_topRecords.clear();
+    for (int index : m_topKeys)
+    {
+        m_topRecords.push_back(m_rankedStates[index]);
+        m_topRecords.back().isGreen = green;
+    }
+    m_frame << "[Top " << m_dashboardTopK << " Congested]\n";
+    printIntersectionsTable(m_frame, m_topRecords);
+}
+
+// ----------------------------------------------------------------
+//   step & runSimulation
+// ----------------------------------------------------------------
+int TrafficSim::step(int count)
+{
+    // Statistics, logging and rendering of step N overlap with spawning and updating step N+1
+    m_pipeline.start();
+
+    // Only the full dashboard needs every intersection in every snapshot
+    m_sparseSnapshots = m_dashboardTopK > 0 || !m_consoleSink->enabled();
+
+    // Steps are measured on the threads this simulation owns: the caller and the pipeline stages
+    if (m_allocationTracking) {
+        m_allocationBlocks.assign(1, AllocationTracker::threadBlock());
+        for (std::size_t s = 0; s < m_pipeline.stageCount(); ++s) {
+            m_allocationBlocks.push_back(m_pipeline.allocationBlock(s));
+        }
+    }
+
+#ifdef TRAFFICSIM_HAS_PROFILER
+    if (m_profiler && !m_profiler->running() && !m_profiler->start(m_profilerHz)) {
+        reportError("[Error] Could not start the sampling profiler (is another one running?).\n");
+        m_profiler.reset();
+    }
+#endif
+
+    int executed = 0;
+    while (executed < count && m_currentStep < m_maxSteps && m_stopReason == StopReason::Running)
+    {
+        ++m_currentStep;
+        if (m_allocationTracking) {
+            AllocationTracker::snapshot(m_allocationBlocks.data(), m_allocationBlocks.size(), m_stepAllocationMark);
+        }
+
+        // 1) Start or clear incidents and pick up routes repaired in the background
+        applyIncidents();
+        if (m_routing) {
+            rerouteAffected();
+        }
+
+        // 2) Spawn new vehicles
+        spawnVehicles();
+
+        // 3) Update each intersection; vehicles crossing a stop line leave or drive on
+        {
+            AllocationScope phase(AllocationPhase::Update);
+            for (Intersection &inter : m_intersections)
+            {
+                bool changed = inter.hasChanged();
+                inter.update();
+                if (!changed && inter.hasChanged()) {
+                    m_changedIndices.push_back(inter.getId() - 1);
+                }
+                releaseExited(inter);
+            }
+            if (m_routing) {
+                applyTransfers();
+                updateRouteCosts();
+            }
+        }
+
+        // 4) Stop early once throughput and queues have settled
+        if (m_steadyStateDetection) {
+            observeSteadyState();
+        }
+
+        // 5) Hand the step over to the statistics, logging and display stages
+        publishStep();
+        ++executed;
+    }
+    if (m_stopReason == StopReason::Running && m_currentStep >= m_maxSteps) {
+        m_stopReason = StopReason::MaxSteps;
     }
 
+    m_pipeline.drain();
+    return executed;
+}
+
+void TrafficSim::runSimulation()
+{
+    m_consoleSink->write("\nStarting TrafficSim Simulation...\n");
+
+    step(m_maxSteps);
+    m_pipeline.stop();
+
     // Final message
-    std::cout << ANSI_CLEAR_SCREEN;
-    std::cout << "=== TrafficSimCPP Simulation Complete ===\n\n"
-              << "Total steps: " << m_maxSteps << "\n"
-              << "Check logs/simulation_log.txt for details.\n\n";
+    std::ostringstream summary;
+    summary << ANSI_CLEAR_SCREEN
+            << "=== TrafficSimCPP Simulation Complete ===\n\n"
+            << "Total steps: " << m_currentStep << "\n"
+            << (m_stopReason == StopReason::SteadyState ? "Stopped early: steady state reached.\n" : "")
+            << "\n";
+    m_consoleSink->write(summary.str());
+
+    logMessage("[Simulation Complete] " + std::to_string(m_currentStep) + " steps processed.\n");
+    if (m_allocationTracking) {
+        std::ostringstream allocations;
+        writeAllocationSummary(allocations);
+        logMessage("[Allocations]\n" + allocations.str());
+    }
+    writeProfile();
+}
+
+bool TrafficSim::writeProfile()
+{
+#ifdef TRAFFICSIM_HAS_PROFILER
+    if (!m_profiler) {
+        return true;
+    }
+    m_profiler->stop();
+
+    std::string error;
+    if (!m_profiler->writeFoldedStacks(m_profilerOutput, error)) {
+        reportError(error);
+        return false;
+    }
+    logMessage("[Profiler] Wrote " + std::to_string(m_profiler->sampleCount()) + " samples ("
+               + std::to_string(m_profiler->droppedCount()) + " dropped) to " + m_profilerOutput + ".\n");
+#endif
+    return true;
+}
+
+// ----------------------------------------------------------------
+//   generateReport
+// ----------------------------------------------------------------
+bool TrafficSim::generateReport(const std::string &filename)
+{
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        reportError("[Error] Could not open report file: " + filename + "\n");
+        return false;
+    }
 
-    logMessage("[Simulation Complete] " + std::to_string(m_maxSteps) + " steps processed.\n");
+    const char *reason = "not finished";
+    if (m_stopReason == StopReason::MaxSteps) {
+        reason = "max_simulation_steps reached";
+    } else if (m_stopReason == StopReason::SteadyState) {
+        reason = "steady state reached";
+    }
+
+    out << "=== TrafficSimCPP Simulation Report ===\n\n"
+        << "Steps executed: " << m_currentStep << " of " << m_maxSteps << "\n"
+        << "Stop reason: " << reason << "\n"
+        << "Vehicles spawned: " << m_vehicles.issuedCount() << "\n"
+        << "Vehicles in network: " << m_vehicles.size() << "\n";
+
+    if (m_allocationTracking) {
+        out << "\n";
+        writeAllocationSummary(out);
+        out << "\n";
+    }
+
+    if (!m_steadyStateDetection) {
+        out << "Steady-state detection: off\n\n"
+            << "ID | Throughput | Waiting\n";
+        for (const Intersection &inter : m_intersections) {
+            out << inter.getId() << " | " << inter.getThroughput() << " | " << inter.getWaitingCount() << "\n";
+        }
+        return static_cast<bool>(out);
+    }
+
+    const int warmup = m_steadyState.warmupSteps();
+    out << "Steady-state detection: on (tolerance " << m_steadyStateTolerance
+        << ", batch size " << m_steadyState.batchSize()
+        << ", batches " << m_steadyState.batchCount() << ")\n";
+    if (warmup > 0) {
+        out << "Warm-up cut: after step " << warmup << " (steady-state means exclude steps 1-" << warmup << ")\n";
+    } else {
+        out << "Warm-up cut: none (steady-state means cover every step)\n";
+    }
+    out << "Network passed/step: " << m_steadyState.mean(0) << " +/- " << m_steadyState.halfWidth(0) << "\n"
+        << "Network waiting: " << m_steadyState.mean(1) << " +/- " << m_steadyState.halfWidth(1) << "\n\n"
+        << "ID | Throughput | Waiting | Passed/step (mean +/- 95% CI) | Waiting (mean +/- 95% CI)\n";
+    for (int i = 0; i < m_numIntersections; ++i) {
+        const Intersection &inter = m_intersections[i];
+        const int s = kNetworkSeries + 2 * i;
+        out << inter.getId() << " | " << inter.getThroughput() << " | " << inter.getWaitingCount()
+            << " | " << m_steadyState.mean(s) << " +/- " << m_steadyState.halfWidth(s)
+            << " | " << m_steadyState.mean(s + 1) << " +/- " << m_steadyState.halfWidth(s + 1) << "\n";
+    }
+    return static_cast<bool>(out);
 }
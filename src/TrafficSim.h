@@ -1,20 +1,88 @@
 #pragma once
 #include <vector>
-#include <map>
 #include <string>
-#include <fstream>
+#include <istream>
+#include <sstream>
 #include <memory>
+#include "AllocationTracker.h"
 #include "Intersection.h"
+#include "DemandProfile.h"
+#include "IndexedHeap.h"
+#include "OutputSink.h"
 #include "RandomGen.h"
+#include "RoadNetwork.h"
+#include "Router.h"
+#include "Span.h"
+#include "SteadyStateDetector.h"
+#include "StepPipeline.h"
+#include "VehicleRegistry.h"
+#ifdef TRAFFICSIM_HAS_PROFILER
+#include "SamplingProfiler.h"
+#endif
 
 /**
  * @class TrafficSim
  * @brief Manages the traffic simulation.
  * 
  * The TrafficSim class is responsible for initializing the simulation, loading the configuration, spawning vehicles, updating intersections, and logging the simulation progress.
+ * It is the public entry point of the trafficsim library: embedders configure it from memory, drive it with
+ * step() and read intersection state through spans. Nothing is written anywhere unless a sink is attached.
  */
 class TrafficSim {
 public:
+    /**
+     * @enum StopReason
+     * @brief Why the simulation stopped advancing.
+     */
+    enum class StopReason {
+        Running, ///< The run has not ended yet.
+        MaxSteps, ///< max_simulation_steps was reached.
+        SteadyState ///< Every monitored series became stationary.
+    };
+
+    /**
+     * @struct IntersectionRecord
+     * @brief Stores information about a single intersection at a particular simulation step.
+     */
+    struct IntersectionRecord {
+        int id; ///< The unique identifier of the intersection.
+        bool isGreen; ///< Indicates if the traffic light is green.
+        int waitingCount; ///< The number of vehicles waiting at the intersection.
+        int passedThisStep; ///< The number of vehicles that passed through the intersection in the current step.
+        int totalThroughput; ///< The total number of vehicles that have passed through the intersection.
+    };
+
+    /**
+     * @struct SpawnRecord
+     * @brief Stores information about vehicles that spawned at a particular step.
+     */
+    struct SpawnRecord {
+        int stepNumber; ///< The simulation step number.
+        std::uint64_t vehicleId; ///< The unique identifier of the vehicle.
+        std::string vehicleType; ///< The type of the vehicle (e.g., "Car" or "Truck").
+        int intersectionAssigned; ///< The intersection where the vehicle was assigned.
+        int destination; ///< The intersection the trip ends at, 0 if the vehicle leaves after the first one.
+    };
+
+    /**
+     * @struct StepRecord
+     * @brief Stores a snapshot of the simulation after a single step.
+     *
+     * A dense snapshot lists every intersection. A sparse one, published when nothing draws the
+     * full dashboard, lists only the intersections that changed, so publishing costs O(changed);
+     * the pipeline stages keep their own mirrors of the full state. Records in getHistory() are
+     * always dense.
+     */
+    struct StepRecord {
+        int stepNumber; ///< The simulation step number.
+        bool sparse; ///< True if intersectionStates only holds the changed intersections.
+        std::vector<IntersectionRecord> intersectionStates; ///< Every intersection by index, or only the changed ones in changedIntersections order if sparse.
+        std::vector<SpawnRecord> spawnedVehicles; ///< The vehicles spawned at the current step.
+        std::vector<int> changedIntersections; ///< Indices (id - 1) of the intersections whose counts changed this step (light toggles excluded).
+        std::vector<std::string> events; ///< Incidents and re-routing that happened this step.
+        AllocationSnapshot allocations; ///< Heap activity of this simulation's threads during the step, zero unless allocation tracking is on.
+    };
+
     /**
      * @brief Constructor for the TrafficSim class.
      */
@@ -33,22 +101,189 @@ public:
      */
     bool initialize(const std::string &configPath);
 
+    /**
+     * @brief Initializes the simulation from configuration text held in memory.
+     * 
+     * Calling it again starts a new run in place: intersections, lanes, the vehicle registry and
+     * the record buffers are reset rather than reconstructed, so their storage is reused.
+     * 
+     * @param config A stream of `key = value` configuration lines.
+     * @return True if initialization is successful, false otherwise.
+     */
+    bool initialize(std::istream &config);
+
+    /**
+     * @brief Routes one kind of output to a sink. Every channel starts as a NullSink.
+     * 
+     * Must not be called while steps are running.
+     * 
+     * @param channel The output channel to redirect.
+     * @param sink The new destination; nullptr restores the NullSink.
+     */
+    void setSink(OutputChannel channel, std::shared_ptr<OutputSink> sink);
+
+    /**
+     * @brief Enables or disables the per-step history returned by getHistory().
+     * 
+     * The history is on by default. Turning it off keeps memory flat for long or repeated runs.
+     * 
+     * @param enabled True to record a StepRecord per step.
+     */
+    void setRecordHistory(bool enabled) { m_recordHistory = enabled; }
+
+    /**
+     * @brief Advances the simulation by up to count steps.
+     * 
+     * Returns once the statistics, logging and rendering of every executed step have finished,
+     * so the state read afterwards is consistent.
+     * 
+     * @param count The number of steps to run.
+     * @return The number of steps executed (fewer once max_simulation_steps is reached).
+     */
+    int step(int count = 1);
+
     /**
      * @brief Runs the traffic simulation.
      */
     void runSimulation();
 
+    /**
+     * @brief Gets a zero-copy view of the intersections, ordered by id (id 1 at index 0).
+     * 
+     * The view is invalidated by an initialize() that configures more intersections than before.
+     * 
+     * @return A span over the intersections.
+     */
+    Span<const Intersection> getIntersections() const {
+        return Span<const Intersection>(m_intersections.data(), m_intersections.size());
+    }
+
+    /**
+     * @brief Gets a zero-copy view of the recorded step history.
+     * 
+     * The view is invalidated by the next call to step().
+     * 
+     * @return A span over one StepRecord per executed step.
+     */
+    Span<const StepRecord> getHistory() const {
+        return Span<const StepRecord>(m_simHistory.data(), m_simHistory.size());
+    }
+
+    /**
+     * @brief Gets the registry of vehicles currently in the network.
+     * 
+     * @return The vehicle registry.
+     */
+    const VehicleRegistry &getVehicles() const { return m_vehicles; }
+
+    /**
+     * @brief Gets the number of the last executed step.
+     * 
+     * @return The current step, 0 before the first step.
+     */
+    int getCurrentStep() const { return m_currentStep; }
+
+    /**
+     * @brief Gets the configured number of steps.
+     * 
+     * @return The value of max_simulation_steps.
+     */
+    int getMaxSteps() const { return m_maxSteps; }
+
+    /**
+     * @brief Gets why the simulation stopped.
+     * 
+     * @return StopReason::Running until the last step of the run has been executed.
+     */
+    StopReason getStopReason() const { return m_stopReason; }
+
+    /**
+     * @brief Gets the number of leading steps discarded as warm-up by steady-state detection.
+     * 
+     * @return The warm-up cut in steps, 0 if detection is off.
+     */
+    int getWarmupSteps() const { return m_steadyStateDetection ? m_steadyState.warmupSteps() : 0; }
+
+    /**
+     * @brief Gets the number of steps whose simulation-thread phases allocated more than allocation_budget times.
+     * 
+     * @return The number of over-budget steps, 0 if no budget is configured.
+     */
+    int getAllocationBudgetViolations() const { return m_allocationBudgetViolations; }
+
+    /**
+     * @brief Gets the file the sampling profiler writes its folded stacks to.
+     * 
+     * @return The configured profiler_output, empty if the profiler is off.
+     */
+    const std::string &getProfilerOutput() const { return m_profilerOutput; }
+
+    /**
+     * @brief Generates a final report of the simulation.
+     * 
+     * Records the executed steps, why the run stopped, the warm-up cut and per-intersection
+     * totals. With steady-state detection on, it also lists each intersection's steady-state
+     * means with their 95% confidence half-widths; with allocation tracking on, the heap activity
+     * of every phase.
+     * 
+     * @param filename The name of the report file.
+     * @return True if the report was written, false otherwise.
+     */
+    bool generateReport(const std::string &filename);
+
+    /**
+     * @brief Stops the sampling profiler and writes its folded stacks to profiler_output.
+     * 
+     * runSimulation() calls it at the end of the run; embedders driving step() call it themselves.
+     * Does nothing unless profiler_output is configured.
+     * 
+     * @return False if the profile could not be written.
+     */
+    bool writeProfile();
+
 private:
     /**
-     * @brief Loads the configuration from the specified file.
+     * @struct Incident
+     * @brief A scheduled closure of an intersection or of the road between two intersections.
+     */
+    struct Incident {
+        int startStep; ///< The first step of the closure.
+        int duration; ///< The number of steps the closure lasts.
+        int from; ///< The closed intersection id, or one end of the closed road.
+        int to; ///< The other end of the closed road, 0 for an intersection closure.
+    };
+
+    /**
+     * @struct Transfer
+     * @brief A vehicle that crossed a stop line and drives on to another intersection.
+     */
+    struct Transfer {
+        VehicleHandle handle; ///< The vehicle.
+        int to; ///< The intersection id it enters.
+    };
+
+    /**
+     * @brief Loads the configuration from a stream.
      * 
-     * @param path The path to the configuration file.
+     * @param in The stream of configuration lines.
      * @return True if the configuration is loaded successfully, false otherwise.
      */
-    bool loadConfig(const std::string &path);
+    bool loadConfig(std::istream &in);
+
+    /**
+     * @brief Restores every configuration value to its default before a config is loaded.
+     */
+    void resetConfig();
+
+    /**
+     * @brief Sends a message to the error sink.
+     * 
+     * @param message The message to be reported.
+     */
+    void reportError(const std::string &message);
 
     /**
-     * @brief Logs a message to the simulation log file.
+     * @brief Logs a message to the log sink.
      * 
      * @param message The message to be logged.
      */
@@ -56,65 +291,233 @@ private:
 
     /**
      * @brief Spawns vehicles at random intersections.
+     *
+     * When a demand profile covers the current step, arrivals, intersections and vehicle types are
+     * drawn from it; otherwise m_vehiclesPerStep vehicles are spawned uniformly with a 50/50 mix.
      */
     void spawnVehicles();
 
+    /**
+     * @brief Starts and clears the incidents scheduled for the current step.
+     */
+    void applyIncidents();
+
+    /**
+     * @brief Closes or reopens the intersection or link of an incident.
+     *
+     * Closures are counted, so with overlapping incidents the place reopens only when the last one
+     * clears.
+     *
+     * @param incident The incident.
+     * @param closed True when the incident starts, false when it clears.
+     */
+    void setIncident(const Incident &incident, bool closed);
+
+    /**
+     * @brief Adopts the routes repaired in the background and re-routes the vehicles they affect.
+     *
+     * Only vehicles queued at an intersection whose next hop toward their own destination changed
+     * are touched.
+     */
+    void rerouteAffected();
+
+    /**
+     * @brief Releases the vehicles that crossed an intersection's stop line this step.
+     *
+     * Vehicles at the end of their trip leave the network; routed vehicles are queued to enter
+     * their next intersection once every intersection has been updated.
+     *
+     * @param inter The intersection that was just updated.
+     */
+    void releaseExited(const Intersection &inter);
+
+    /**
+     * @brief Moves the vehicles released this step onto their next intersection and plans the hop after it.
+     */
+    void applyTransfers();
+
+    /**
+     * @brief Feeds queue-based delay estimates to the router.
+     *
+     * An intersection's estimate is only passed on when it moved by more than route_cost_threshold
+     * relative to its last reported value, so small fluctuations do not trigger tree repairs.
+     */
+    void updateRouteCosts();
+
+    /**
+     * @brief Adds a vehicle to an intersection's approach lane and notes the intersection as changed.
+     *
+     * @param interId The intersection id.
+     * @param handle The vehicle's handle.
+     * @param vehicle The vehicle.
+     */
+    void admitVehicle(int interId, VehicleHandle handle, const Vehicle &vehicle);
+
+    /**
+     * @brief Looks up where a vehicle at an intersection drives next.
+     *
+     * @param interId The intersection the vehicle is queued at.
+     * @param destination The vehicle's destination id, 0 for none.
+     * @return The next intersection id, or 0 if the vehicle leaves the network there.
+     */
+    int routeFrom(int interId, int destination);
+
+    /**
+     * @brief Feeds every intersection's throughput and waiting count to the steady-state detector.
+     *
+     * The network totals of both are fed as well and alone choose the warm-up cut. Ends the run once the detector reports every series stationary.
+     */
+    void observeSteadyState();
+
+    /**
+     * @brief Charges the heap activity of this simulation's threads during the step to its record and checks the budget.
+     *
+     * @param record The record of the step being published.
+     */
+    void measureAllocations(StepRecord &record);
+
+    /**
+     * @brief Writes the run's process-wide allocation totals per phase, the peak heap and the budget violations.
+     *
+     * @param out The stream to write to.
+     */
+    void writeAllocationSummary(std::ostream &out) const;
+
+    /**
+     * @brief Copies this step's intersection states and spawns into a snapshot and publishes it.
+     *
+     * The snapshot buffer is recycled from two steps earlier, so its vectors keep their capacity.
+     * Sparse snapshots only copy the intersections listed in m_changedIndices.
+     */
+    void publishStep();
+
     /**
      * @brief Records the state of the simulation at each step.
+     *
+     * Statistics stage of the step pipeline.
+     *
+     * @param record The published snapshot of the step.
      */
-    void recordStepData();
+    void recordStepData(const StepRecord &record);
 
     /**
-     * @brief Generates a final report of the simulation.
-     * 
-     * @param filename The name of the report file.
+     * @brief Writes the spawn and update messages of a step to the log file.
+     *
+     * Logging stage of the step pipeline.
+     *
+     * @param record The published snapshot of the step.
      */
-    void generateReport(const std::string &filename);
+    void logStepData(const StepRecord &record);
 
     /**
-     * @struct IntersectionRecord
-     * @brief Stores information about a single intersection at a particular simulation step.
+     * @brief Draws the live dashboard for a step and writes it to the console sink.
+     *
+     * Rendering stage of the step pipeline. Does nothing but keep the rankings current when the
+     * console sink is disabled.
+     *
+     * @param record The published snapshot of the step.
      */
-    struct IntersectionRecord {
-        int id; ///< The unique identifier of the intersection.
-        bool isGreen; ///< Indicates if the traffic light is green.
-        int waitingCount; ///< The number of vehicles waiting at the intersection.
-        int passedThisStep; ///< The number of vehicles that passed through the intersection in the current step.
-        int totalThroughput; ///< The total number of vehicles that have passed through the intersection.
-    };
+    void renderStep(const StepRecord &record);
 
     /**
-     * @struct SpawnRecord
-     * @brief Stores information about vehicles that spawned at a particular step.
+     * @brief Re-ranks the intersections whose state changed and updates the network totals.
+     *
+     * Only the intersections listed in record.changedIntersections are touched, so this costs
+     * O(changed * log n) instead of O(n). Also keeps m_rankedStates current.
+     *
+     * @param record The published snapshot of the step.
      */
-    struct SpawnRecord {
-        int stepNumber; ///< The simulation step number.
-        int vehicleId; ///< The unique identifier of the vehicle.
-        std::string vehicleType; ///< The type of the vehicle (e.g., "Car" or "Truck").
-        int intersectionAssigned; ///< The intersection where the vehicle was assigned.
-    };
+    void updateRankings(const StepRecord &record);
 
     /**
-     * @struct StepRecord
-     * @brief Stores a snapshot of the simulation after a single step.
+     * @brief Formats the top-K hot-spot dashboard and network-wide totals into the current frame.
+     *
+     * @param record The published snapshot of the step.
      */
-    struct StepRecord {
-        int stepNumber; ///< The simulation step number.
-        std::vector<IntersectionRecord> intersectionStates; ///< The states of the intersections at the current step.
-        std::vector<SpawnRecord> spawnedVehicles; ///< The vehicles spawned at the current step.
-    };
+    void renderTopK(const StepRecord &record);
 
-    std::map<int, Intersection> m_intersections; ///< The map of intersections in the simulation.
+    std::vector<Intersection> m_intersections; ///< The intersections of the simulation, id i at index i - 1.
     int m_numIntersections; ///< The number of intersections in the simulation.
     int m_vehiclesPerStep; ///< The number of vehicles to spawn per simulation step.
     int m_maxSteps; ///< The maximum number of simulation steps.
     RandomGen m_rng; ///< The random number generator for the simulation.
+    VehicleRegistry m_vehicles; ///< Owns every live vehicle and hands out unique ids.
 
     int m_greenTime; ///< The duration of the green light for all intersections.
     int m_redTime; ///< The duration of the red light for all intersections.
 
-    std::ofstream m_logFile; ///< The log file for the simulation.
+    double m_laneLength; ///< The length of every approach lane in metres.
+    double m_stepSeconds; ///< The simulated time covered by one step in seconds.
+    int m_subSteps; ///< The number of car-following sub-steps per simulation step.
+
+    std::string m_demandProfilePath; ///< The demand profile file, empty if none is configured.
+    DemandProfile m_demand; ///< Time-varying demand driving spawnVehicles.
+
+    int m_frameDelayMs; ///< Pause after each dashboard frame so the updates are visible.
+
+    std::shared_ptr<OutputSink> m_consoleSink; ///< Receives the dashboard and progress messages.
+    std::shared_ptr<OutputSink> m_logSink; ///< Receives the simulation log.
+    std::shared_ptr<OutputSink> m_errorSink; ///< Receives configuration and I/O errors.
+    std::ostringstream m_frame; ///< Reused buffer a dashboard frame is built in (render stage only).
     int m_currentStep; ///< The current simulation step.
 
     std::vector<StepRecord> m_simHistory; ///< The history of the simulation steps.
+
+    std::vector<SpawnRecord> m_stepSpawns; ///< Vehicles spawned during the step being simulated.
+    std::vector<int> m_changedIndices; ///< Intersections changed since the last publish, in order of first change.
+    bool m_sparseSnapshots; ///< True if the current steps publish sparse snapshots.
+    std::vector<IntersectionRecord> m_historyStates; ///< Full intersection states rebuilt from snapshots (statistics stage only).
+    StepPipeline<StepRecord> m_pipeline; ///< Runs statistics, logging and rendering off the simulation thread.
+
+    int m_dashboardTopK; ///< Number of hot spots shown by the dashboard, 0 to show every intersection.
+    IndexedHeap m_busiest; ///< Intersections ranked by total throughput (render stage only).
+    IndexedHeap m_congested; ///< Intersections ranked by waiting vehicles (render stage only).
+    std::vector<int> m_topKeys; ///< Scratch list of ranked intersection indices (render stage only).
+    std::vector<IntersectionRecord> m_topRecords; ///< Scratch rows of the ranked intersections (render stage only).
+    std::vector<IntersectionRecord> m_rankedStates; ///< Latest state of every intersection (render stage only).
+    long long m_networkWaiting; ///< Vehicles on all approaches, kept incrementally (render stage only).
+    long long m_networkThroughput; ///< Vehicles through all intersections, kept incrementally (render stage only).
+    int m_networkPassed; ///< Vehicles through all intersections in the last ranked step (render stage only).
+    int m_spinnerFrame; ///< Position of the progress spinner (render stage only).
+
+    bool m_routing; ///< True if vehicles drive multi-intersection trips along dynamic routes.
+    int m_routingThreads; ///< The number of background route repair threads.
+    double m_routeCostThreshold; ///< Relative delay change that is passed on to the router.
+    std::vector<Incident> m_incidents; ///< Scheduled closures from the config.
+    std::vector<int> m_nodeClosures; ///< Active incidents per intersection index.
+    std::vector<int> m_linkClosures; ///< Active incidents per road, counted on the from < to link.
+    RoadNetwork m_network; ///< Grid of roads connecting the intersections.
+    Router m_router; ///< Cached shortest-path trees over m_network.
+    std::vector<Transfer> m_transfers; ///< Vehicles changing intersection during the current step.
+    std::vector<std::pair<int, int>> m_routeChanges; ///< Scratch list of (node, destination) next hops that changed.
+    std::vector<char> m_destinationChanged; ///< Scratch flags of the destinations changed at one node.
+    std::vector<double> m_reportedDelay; ///< Last delay estimate passed to the router per intersection.
+    std::vector<std::string> m_stepEvents; ///< Events of the step being simulated.
+
+    bool m_steadyStateDetection; ///< True if the run stops once it reaches a steady state.
+    double m_steadyStateTolerance; ///< Allowed confidence half-width relative to the mean.
+    int m_steadyStateBatchSize; ///< Initial number of steps per batch.
+    int m_steadyStateMinBatches; ///< Batches required after the warm-up cut.
+    SteadyStateDetector m_steadyState; ///< Warm-up removal and convergence test.
+    StopReason m_stopReason; ///< Why the run stopped, Running while it goes on.
+
+    std::string m_profilerOutput; ///< Folded-stack output of the sampling profiler, empty if off.
+    int m_profilerHz; ///< Profiler samples per second of CPU time.
+#ifdef TRAFFICSIM_HAS_PROFILER
+    std::unique_ptr<SamplingProfiler> m_profiler; ///< Samples call stacks while steps run.
+#endif
+
+    bool m_allocationReport; ///< True if allocations are logged per step and summarized at the end.
+    long long m_allocationBudget; ///< Allowed simulation-thread allocations per step, -1 for no budget.
+    bool m_allocationTracking; ///< True if steps are measured this run.
+    AllocationSnapshot m_allocationStart; ///< Process-wide counters when the run was initialized.
+    AllocationSnapshot m_allocationMark; ///< Process-wide counters when the previous step was published.
+    std::vector<int> m_allocationBlocks; ///< Counter blocks of this simulation's threads: the caller of step(), then the pipeline stages.
+    AllocationSnapshot m_stepAllocationMark; ///< Counters of m_allocationBlocks when the current step began.
+    std::int64_t m_allocationPeak; ///< Highest live heap of the run.
+    int m_allocationBudgetViolations; ///< Steps that went over m_allocationBudget.
+
+    bool m_hasSeed; ///< True if the config fixes the random seed.
+    unsigned long m_seed; ///< The configured random seed.
+    bool m_recordHistory; ///< Whether recordStepData keeps a copy of every step.
 };
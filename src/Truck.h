@@ -16,7 +16,7 @@ public:
      * @param id The unique identifier for the truck.
      * @param speed The speed of the truck.
      */
-    Truck(int id, double speed)
+    Truck(std::uint64_t id, double speed)
         : LandVehicle(id, speed, 6) {
     }
 
@@ -25,6 +25,23 @@ public:
      */
     ~Truck() override = default;
 
+    /**
+     * @brief Move constructor for the Truck class.
+     * 
+     * Lets the vehicle registry keep trucks by value in a dense array.
+     * 
+     * @param other The Truck object to move from.
+     */
+    Truck(Truck&& other) noexcept = default;
+
+    /**
+     * @brief Move assignment operator for the Truck class.
+     * 
+     * @param other The Truck object to move from.
+     * @return A reference to the assigned Truck object.
+     */
+    Truck& operator=(Truck&& other) noexcept = default;
+
     /**
      * @brief Updates the state of the truck.
      * 
@@ -34,4 +51,14 @@ public:
         // Example: Just print that we're updating
         std::cout << "[Truck] ID=" << m_id << " updating state.\n";
     }
+
+    /**
+     * @brief Gets the car-following parameters of the truck.
+     * 
+     * @return The Intelligent Driver Model parameters of the truck.
+     */
+    IdmParams getIdmParams() const override {
+        // v0 (m/s), T (s), a (m/s^2), b (m/s^2), s0 (m), length (m)
+        return IdmParams{ m_speed / 3.6, 1.8, 0.7, 1.5, 3.0, 12.0 };
+    }
 };
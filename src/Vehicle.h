@@ -1,5 +1,7 @@
 #pragma once
 #include "TrafficObject.h"
+#include "IdmParams.h"
+#include <cstdint>
 #include <string>
 #include <iostream>
 
@@ -15,11 +17,11 @@ public:
     /**
      * @brief Constructor for the Vehicle class.
      * 
-     * @param id The unique identifier for the vehicle.
+     * @param id The unique identifier for the vehicle (0 is reserved for "no vehicle").
      * @param speed The speed of the vehicle.
      */
-    Vehicle(int id, double speed)
-        : m_id(id), m_speed(speed) {}
+    Vehicle(std::uint64_t id, double speed)
+        : m_id(id), m_speed(speed), m_destination(0), m_nextHop(0) {}
 
     /**
      * @brief Virtual destructor for the Vehicle class.
@@ -32,7 +34,8 @@ public:
      * @param other The Vehicle object to copy from.
      */
     Vehicle(const Vehicle& other)
-        : m_id(other.m_id), m_speed(other.m_speed) {}
+        : m_id(other.m_id), m_speed(other.m_speed),
+          m_destination(other.m_destination), m_nextHop(other.m_nextHop) {}
 
     /**
      * @brief Move constructor for the Vehicle class.
@@ -40,8 +43,9 @@ public:
      * @param other The Vehicle object to move from.
      */
     Vehicle(Vehicle&& other) noexcept
-        : m_id(other.m_id), m_speed(other.m_speed) {
-        other.m_id = -1;
+        : m_id(other.m_id), m_speed(other.m_speed),
+          m_destination(other.m_destination), m_nextHop(other.m_nextHop) {
+        other.m_id = 0;
         other.m_speed = 0.0;
     }
 
@@ -55,7 +59,9 @@ public:
         if (this != &other) {
             m_id = other.m_id;
             m_speed = other.m_speed;
-            other.m_id = -1;
+            m_destination = other.m_destination;
+            m_nextHop = other.m_nextHop;
+            other.m_id = 0;
             other.m_speed = 0.0;
         }
         return *this;
@@ -101,21 +107,58 @@ public:
      */
     virtual void updateState() override = 0;
 
+    /**
+     * @brief Gets the car-following parameters used when the vehicle drives on an approach lane.
+     * 
+     * @return The Intelligent Driver Model parameters of the vehicle.
+     */
+    virtual IdmParams getIdmParams() const = 0;
+
     /**
      * @brief Gets the unique identifier of the vehicle.
      * 
      * @return The unique identifier of the vehicle.
      */
-    int getId() const { return m_id; }
+    std::uint64_t getId() const { return m_id; }
 
     /**
      * @brief Gets the speed of the vehicle.
      * 
-     * @return The speed of the vehicle.
+     * @return The speed of the vehicle in km/h.
      */
     double getSpeed() const { return m_speed; }
 
+    /**
+     * @brief Gets the intersection the vehicle's trip ends at.
+     * 
+     * @return The destination intersection id, or 0 if the vehicle leaves after its first intersection.
+     */
+    int getDestination() const { return m_destination; }
+
+    /**
+     * @brief Sets the intersection the vehicle's trip ends at.
+     * 
+     * @param destination The destination intersection id, or 0 for none.
+     */
+    void setDestination(int destination) { m_destination = destination; }
+
+    /**
+     * @brief Gets the intersection the vehicle drives to after crossing its current stop line.
+     * 
+     * @return The next intersection id, or 0 if the vehicle leaves the network there.
+     */
+    int getNextHop() const { return m_nextHop; }
+
+    /**
+     * @brief Sets the intersection the vehicle drives to after crossing its current stop line.
+     * 
+     * @param nextHop The next intersection id, or 0 to leave the network.
+     */
+    void setNextHop(int nextHop) { m_nextHop = nextHop; }
+
 protected:
-    int m_id; ///< The unique identifier of the vehicle.
-    double m_speed; ///< The speed of the vehicle.
+    std::uint64_t m_id; ///< The unique identifier of the vehicle.
+    double m_speed; ///< The speed of the vehicle in km/h, used as its desired cruising speed.
+    int m_destination; ///< The intersection id the trip ends at, 0 for none.
+    int m_nextHop; ///< The intersection id planned after the current one, 0 to leave the network.
 };
@@ -0,0 +1,281 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Car.h"
+#include "Truck.h"
+
+/**
+ * @struct VehicleHandle
+ * @brief Lightweight reference to a vehicle stored in a VehicleRegistry.
+ *
+ * A handle stays cheap to copy and never dangles: once the vehicle it refers to is removed,
+ * the slot's generation changes and the handle is reported as stale.
+ */
+struct VehicleHandle {
+    std::uint32_t index; ///< The slot index inside the registry.
+    std::uint32_t generation; ///< The generation of the slot when the handle was issued.
+
+    /**
+     * @brief Overloads the equality operator for the VehicleHandle struct.
+     *
+     * @param other The VehicleHandle to compare with.
+     * @return True if both handles refer to the same slot and generation, false otherwise.
+     */
+    bool operator==(const VehicleHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+
+    /**
+     * @brief Overloads the inequality operator for the VehicleHandle struct.
+     *
+     * @param other The VehicleHandle to compare with.
+     * @return True if the handles differ, false otherwise.
+     */
+    bool operator!=(const VehicleHandle& other) const {
+        return !(*this == other);
+    }
+};
+
+/**
+ * @class VehicleRegistry
+ * @brief Generational slot map owning every live vehicle of the simulation.
+ *
+ * Vehicles are stored by value in one dense array per concrete type, so iterating over the live
+ * population touches no holes and no per-vehicle heap blocks. A sparse slot array maps handles to
+ * a type tag and a dense position, giving O(1) insertion, lookup and removal (removal moves the
+ * last vehicle of the same type into the freed position). Lookups hand out the virtual Vehicle
+ * interface as a view into the array. Every vehicle receives a 64-bit id drawn from a
+ * monotonically increasing counter, so ids are never reused during a run.
+ */
+class VehicleRegistry {
+public:
+    /**
+     * @brief Constructor for the VehicleRegistry class.
+     */
+    VehicleRegistry()
+        : m_nextId(1) {}
+
+    /**
+     * @brief Creates a vehicle of type V with a fresh unique id and stores it.
+     *
+     * Pointers returned by get() are invalidated by the next spawn() or remove(); handles are not.
+     *
+     * @tparam V The concrete vehicle type (Car or Truck), constructible as V(id, args...).
+     * @param args The remaining constructor arguments of the vehicle.
+     * @return A handle referring to the new vehicle.
+     */
+    template <typename V, typename... Args>
+    VehicleHandle spawn(Args&&... args) {
+        std::uint32_t slotIndex;
+        if (!m_freeSlots.empty()) {
+            slotIndex = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        } else {
+            slotIndex = static_cast<std::uint32_t>(m_slots.size());
+            m_slots.push_back(Slot{ kFreeSlot, 0, 0 });
+        }
+
+        Pool<V> &pool = poolOf(static_cast<V *>(nullptr));
+        Slot &slot = m_slots[slotIndex];
+        slot.denseIndex = static_cast<std::uint32_t>(pool.vehicles.size());
+        slot.type = typeOf(static_cast<V *>(nullptr));
+        pool.vehicles.emplace_back(m_nextId++, std::forward<Args>(args)...);
+        pool.denseToSlot.push_back(slotIndex);
+
+        return VehicleHandle{ slotIndex, slot.generation };
+    }
+
+    /**
+     * @brief Looks up the vehicle referred to by a handle.
+     *
+     * @param handle The handle to resolve.
+     * @return A pointer to the vehicle, or nullptr if the handle is stale.
+     */
+    Vehicle* get(VehicleHandle handle) {
+        if (!contains(handle)) {
+            return nullptr;
+        }
+        const Slot &slot = m_slots[handle.index];
+        if (slot.type == kCar) {
+            return &m_cars.vehicles[slot.denseIndex];
+        }
+        return &m_trucks.vehicles[slot.denseIndex];
+    }
+
+    /**
+     * @brief Looks up the vehicle referred to by a handle.
+     *
+     * @param handle The handle to resolve.
+     * @return A pointer to the vehicle, or nullptr if the handle is stale.
+     */
+    const Vehicle* get(VehicleHandle handle) const {
+        return const_cast<VehicleRegistry *>(this)->get(handle);
+    }
+
+    /**
+     * @brief Checks whether a handle still refers to a live vehicle.
+     *
+     * @param handle The handle to check.
+     * @return True if the vehicle is alive, false if the handle is stale or invalid.
+     */
+    bool contains(VehicleHandle handle) const {
+        return handle.index < m_slots.size()
+            && m_slots[handle.index].generation == handle.generation
+            && m_slots[handle.index].denseIndex != kFreeSlot;
+    }
+
+    /**
+     * @brief Removes the vehicle referred to by a handle.
+     *
+     * The slot's generation is bumped so every outstanding copy of the handle becomes stale.
+     *
+     * @param handle The handle of the vehicle to remove.
+     * @return True if a vehicle was removed, false if the handle was already stale.
+     */
+    bool remove(VehicleHandle handle) {
+        if (!contains(handle)) {
+            return false;
+        }
+
+        Slot &slot = m_slots[handle.index];
+        if (slot.type == kCar) {
+            erase(m_cars, slot.denseIndex);
+        } else {
+            erase(m_trucks, slot.denseIndex);
+        }
+
+        slot.denseIndex = kFreeSlot;
+        slot.generation++;
+        m_freeSlots.push_back(handle.index);
+        return true;
+    }
+
+    /**
+     * @brief Gets the number of live vehicles.
+     *
+     * @return The number of live vehicles.
+     */
+    std::size_t size() const { return m_cars.vehicles.size() + m_trucks.vehicles.size(); }
+
+    /**
+     * @brief Checks whether the registry holds no vehicles.
+     *
+     * @return True if there are no live vehicles, false otherwise.
+     */
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @brief Gets the total number of vehicle ids issued so far.
+     *
+     * @return The number of vehicles ever spawned through this registry.
+     */
+    std::uint64_t issuedCount() const { return m_nextId - 1; }
+
+    /**
+     * @brief Removes every vehicle and restarts ids at 1, keeping the allocated storage.
+     *
+     * Handles issued before the call must not be used afterwards.
+     */
+    void clear() {
+        m_slots.clear();
+        m_freeSlots.clear();
+        m_cars.vehicles.clear();
+        m_cars.denseToSlot.clear();
+        m_trucks.vehicles.clear();
+        m_trucks.denseToSlot.clear();
+        m_nextId = 1;
+    }
+
+    /**
+     * @brief Reserves room for the given number of live vehicles of each type.
+     *
+     * @param capacity The expected peak number of live vehicles.
+     */
+    void reserve(std::size_t capacity) {
+        m_slots.reserve(capacity);
+        m_cars.vehicles.reserve(capacity);
+        m_cars.denseToSlot.reserve(capacity);
+        m_trucks.vehicles.reserve(capacity);
+        m_trucks.denseToSlot.reserve(capacity);
+    }
+
+    /**
+     * @brief Calls fn(vehicle) for every live vehicle, one type's dense array after the other.
+     *
+     * @param fn Callable taking a Vehicle reference; it must not spawn or remove vehicles.
+     */
+    template <typename Fn>
+    void forEach(Fn &&fn) {
+        for (Car &car : m_cars.vehicles) {
+            fn(static_cast<Vehicle &>(car));
+        }
+        for (Truck &truck : m_trucks.vehicles) {
+            fn(static_cast<Vehicle &>(truck));
+        }
+    }
+
+    /**
+     * @brief Calls fn(vehicle) for every live vehicle, one type's dense array after the other.
+     *
+     * @param fn Callable taking a const Vehicle reference.
+     */
+    template <typename Fn>
+    void forEach(Fn &&fn) const {
+        for (const Car &car : m_cars.vehicles) {
+            fn(static_cast<const Vehicle &>(car));
+        }
+        for (const Truck &truck : m_trucks.vehicles) {
+            fn(static_cast<const Vehicle &>(truck));
+        }
+    }
+
+private:
+    static const std::uint32_t kFreeSlot = 0xFFFFFFFFu; ///< Marks a slot without a live vehicle.
+    static const std::uint8_t kCar = 0; ///< Type tag of vehicles stored in m_cars.
+    static const std::uint8_t kTruck = 1; ///< Type tag of vehicles stored in m_trucks.
+
+    /**
+     * @struct Slot
+     * @brief Sparse entry mapping a handle index to the vehicle's type and dense position.
+     */
+    struct Slot {
+        std::uint32_t denseIndex; ///< Position in the dense array of its type, or kFreeSlot.
+        std::uint32_t generation; ///< Incremented every time the slot is released.
+        std::uint8_t type; ///< Which dense array holds the vehicle.
+    };
+
+    /**
+     * @struct Pool
+     * @brief Dense by-value storage of one concrete vehicle type.
+     */
+    template <typename V>
+    struct Pool {
+        std::vector<V> vehicles; ///< Live vehicles of the type, packed without holes.
+        std::vector<std::uint32_t> denseToSlot; ///< Slot index owning each dense position.
+    };
+
+    Pool<Car> &poolOf(Car *) { return m_cars; }
+    Pool<Truck> &poolOf(Truck *) { return m_trucks; }
+    static std::uint8_t typeOf(Car *) { return kCar; }
+    static std::uint8_t typeOf(Truck *) { return kTruck; }
+
+    // Moves the pool's last vehicle into the freed position and repoints its slot
+    template <typename V>
+    void erase(Pool<V> &pool, std::uint32_t denseIndex) {
+        std::uint32_t lastIndex = static_cast<std::uint32_t>(pool.vehicles.size() - 1);
+        if (denseIndex != lastIndex) {
+            pool.vehicles[denseIndex] = std::move(pool.vehicles[lastIndex]);
+            pool.denseToSlot[denseIndex] = pool.denseToSlot[lastIndex];
+            m_slots[pool.denseToSlot[denseIndex]].denseIndex = denseIndex;
+        }
+        pool.vehicles.pop_back();
+        pool.denseToSlot.pop_back();
+    }
+
+    std::vector<Slot> m_slots; ///< Sparse slots indexed by handle index.
+    std::vector<std::uint32_t> m_freeSlots; ///< Released slot indices available for reuse.
+    Pool<Car> m_cars; ///< Live cars.
+    Pool<Truck> m_trucks; ///< Live trucks.
+    std::uint64_t m_nextId; ///< The id given to the next spawned vehicle.
+};
@@ -1,26 +1,112 @@
 #include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
 #include "TrafficSim.h"
+#ifdef TRAFFICSIM_HAS_SERVER
+#include <csignal>
+#include <cstdlib>
+#include "SimulationServer.h"
+
+static SimulationServer *g_server = nullptr;
+
+// Lets Ctrl+C / SIGTERM shut the server down cleanly
+static void handleStopSignal(int)
+{
+    if (g_server) {
+        g_server->stop();
+    }
+}
+
+/**
+ * @brief Runs the scenario server until it receives SIGINT or SIGTERM.
+ * 
+ * @param socketPath The Unix-domain socket to listen on.
+ * @param workers The number of scenarios run concurrently.
+ * @return int Returns 0 on clean shutdown, 1 on error.
+ */
+static int serve(const std::string &socketPath, int workers)
+{
+    SimulationServer server(socketPath, workers, workers * 4);
+    server.setSink(OutputChannel::Console, std::make_shared<StreamSink>(std::cout));
+    server.setSink(OutputChannel::Error, std::make_shared<StreamSink>(std::cerr));
+    g_server = &server;
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+
+    bool ok = server.run();
+    g_server = nullptr;
+    return ok ? 0 : 1;
+}
+#endif
 
 /**
  * @brief Entry point of the TrafficSimCPP application.
  * 
  * This function initializes the TrafficSim instance, loads the configuration, and runs the simulation.
+ * The configuration path can be given as the first argument (default: config/config.txt).
+ * With `--serve <socket> [workers]` it instead runs as a long-lived scenario server.
  * 
- * @return int Returns 0 on successful completion, 1 on error.
+ * @return int Returns 0 on successful completion, 1 on error, 3 if a step went over allocation_budget.
  */
-int main() {
+int main(int argc, char *argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--serve") {
+#ifdef TRAFFICSIM_HAS_SERVER
+        if (argc < 3) {
+            std::cerr << "Usage: traffic_sim --serve <socket-path> [workers]\n";
+            return 1;
+        }
+        int workers = static_cast<int>(std::thread::hardware_concurrency());
+        if (argc > 3) {
+            char *end = nullptr;
+            long parsed = std::strtol(argv[3], &end, 10);
+            if (end == argv[3] || *end != '\0' || parsed < 1 || parsed > 1024) {
+                std::cerr << "[Error] Invalid worker count: " << argv[3] << "\n"
+                          << "Usage: traffic_sim --serve <socket-path> [workers]\n";
+                return 1;
+            }
+            workers = static_cast<int>(parsed);
+        }
+        return serve(argv[2], workers);
+#else
+        std::cerr << "[Error] Server mode is not available on this platform.\n";
+        return 1;
+#endif
+    }
+
+    const std::string configPath = (argc > 1) ? argv[1] : "config/config.txt";
+
     // Create a TrafficSim instance
     TrafficSim simulator;
 
+    // The library is silent by default; the command-line tool shows everything
+    simulator.setSink(OutputChannel::Console, std::make_shared<StreamSink>(std::cout));
+    simulator.setSink(OutputChannel::Error, std::make_shared<StreamSink>(std::cerr));
+
+    auto logFile = std::make_shared<FileSink>("logs/simulation_log.txt");
+    if (!logFile->isOpen()) {
+        std::cerr << "[Error] Could not open simulation_log.txt for writing.\n";
+        return 1;
+    }
+    simulator.setSink(OutputChannel::Log, logFile);
+
     // Initialize from config.txt (if found) and run
-    if (!simulator.initialize("config/config.txt")) {
+    if (!simulator.initialize(configPath)) {
         std::cerr << "[Error] Failed to initialize simulator from config.\n";
         return 1;
     }
 
     // Run the simulation
     simulator.runSimulation();
+    simulator.generateReport("logs/simulation_report.txt");
 
-    std::cout << "[Info] Simulation complete. Check logs/simulation_log.txt for details.\n";
+    std::cout << "[Info] Simulation complete. Check logs/simulation_log.txt and logs/simulation_report.txt for details.\n";
+
+    // Lets benchmark scripts fail a run that allocates in steps meant to be allocation-free
+    if (simulator.getAllocationBudgetViolations() > 0) {
+        std::cerr << "[Error] " << simulator.getAllocationBudgetViolations()
+                  << " steps exceeded the allocation budget.\n";
+        return 3;
+    }
     return 0;
 }
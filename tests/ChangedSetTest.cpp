@@ -0,0 +1,75 @@
+// Checks that light phase changes do not mark intersections as changed: with one shared light
+// schedule a toggle would otherwise put every intersection into the step's changed set.
+#include <iostream>
+#include <sstream>
+#include "TrafficSim.h"
+
+static int g_failures = 0;
+
+static void check(bool condition, const std::string &message)
+{
+    if (!condition) {
+        std::cerr << "[FAIL] " << message << "\n";
+        ++g_failures;
+    }
+}
+
+// Runs 20 steps of a sparse-snapshot simulation and checks every step's changed set
+static void runScenario(int vehiclesPerStep, std::size_t maxChanged)
+{
+    std::istringstream config("intersections = 1000\n"
+                              "vehicles_per_step = " + std::to_string(vehiclesPerStep) + "\n"
+                              "max_simulation_steps = 20\n"
+                              "traffic_light_green_time = 3\n"
+                              "traffic_light_red_time = 2\n"
+                              "random_seed = 7\n");
+    TrafficSim sim;
+    check(sim.initialize(config), "initialize");
+    sim.step(20);
+
+    Span<const TrafficSim::StepRecord> history = sim.getHistory();
+    check(history.size() == 20, "20 history records");
+    for (const TrafficSim::StepRecord &record : history)
+    {
+        const std::string step = " at step " + std::to_string(record.stepNumber)
+                               + " with " + std::to_string(vehiclesPerStep) + " vehicles/step";
+        check(record.changedIntersections.size() <= maxChanged,
+              std::to_string(record.changedIntersections.size()) + " changed intersections" + step);
+
+        // The light still shows the schedule in the dense history: red on steps 3-4, 8-9, ...
+        bool green = record.stepNumber % 5 < 3;
+        check(record.intersectionStates.size() == 1000, "dense history" + step);
+        for (const TrafficSim::IntersectionRecord &state : record.intersectionStates)
+        {
+            if (state.isGreen != green) {
+                check(false, "light of intersection " + std::to_string(state.id) + step);
+                break;
+            }
+        }
+    }
+
+    // The live intersections agree with the schedule after the last step (20 % 5 == 0: green)
+    for (const Intersection &inter : sim.getIntersections())
+    {
+        if (!inter.isGreen()) {
+            check(false, "live light of intersection " + std::to_string(inter.getId()));
+            break;
+        }
+    }
+}
+
+int main()
+{
+    // Nothing moves: no step may report a change, including the phase changes at steps 3, 5, 8, ...
+    runScenario(0, 0);
+
+    // A few vehicles: only intersections that admitted or released vehicles change, never all of them
+    runScenario(2, 40);
+
+    if (g_failures > 0) {
+        std::cerr << g_failures << " check(s) failed.\n";
+        return 1;
+    }
+    std::cout << "ChangedSetTest passed.\n";
+    return 0;
+}
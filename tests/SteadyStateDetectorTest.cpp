@@ -0,0 +1,61 @@
+// Checks that a run converging on the last batch the detector keeps reports the warm-up cut and
+// batch layout its converged means were computed from.
+#include <iostream>
+#include <string>
+#include "SteadyStateDetector.h"
+
+static int g_failures = 0;
+
+static void check(bool condition, const std::string &message)
+{
+    if (!condition) {
+        std::cerr << "[FAIL] " << message << "\n";
+        ++g_failures;
+    }
+}
+
+// Feeds one value as a whole batch (batch size 1) and returns endStep()'s verdict
+static bool feed(SteadyStateDetector &detector, double value)
+{
+    detector.record(0, value);
+    return detector.endStep();
+}
+
+int main()
+{
+    // 19 warm-up batches (an odd cut), then a plateau at 10 with one outlier at batch 39. With 20
+    // batches required after the cut, batch 39 is the first that could converge; the outlier keeps
+    // its half-width just above 3% of the mean, and batch 40 brings it just below.
+    const int kWarmup = 19;
+    SteadyStateDetector detector;
+    detector.configure(1, 1, 1, 20, 0.03);
+
+    int convergedAt = 0;
+    for (int batch = 1; batch <= SteadyStateDetector::kMaxBatches && convergedAt == 0; ++batch)
+    {
+        double value = batch <= kWarmup ? 100.0 : (batch == 39 ? 13.0 : 10.0);
+        if (feed(detector, value)) {
+            convergedAt = batch;
+        }
+    }
+
+    check(convergedAt == SteadyStateDetector::kMaxBatches,
+          "converged at batch " + std::to_string(convergedAt) + ", expected " + std::to_string(SteadyStateDetector::kMaxBatches));
+    check(detector.batchCount() == SteadyStateDetector::kMaxBatches,
+          "batch count " + std::to_string(detector.batchCount()) + " after converging on the last batch");
+    check(detector.batchSize() == 1, "batch size " + std::to_string(detector.batchSize()) + " after converging on the last batch");
+    check(detector.warmupSteps() == kWarmup, "warm-up " + std::to_string(detector.warmupSteps()) + " steps, expected 19");
+    check(detector.mean(0) > 10.0 && detector.mean(0) < 10.2, "post-cut mean " + std::to_string(detector.mean(0)));
+
+    // Steps after convergence merge the full batch list instead of writing past it
+    feed(detector, 10.0);
+    check(detector.batchCount() == SteadyStateDetector::kMaxBatches / 2, "batches merged on the next step");
+    check(detector.batchSize() == 2, "batch size doubled on the next step");
+
+    if (g_failures > 0) {
+        std::cerr << g_failures << " check(s) failed.\n";
+        return 1;
+    }
+    std::cout << "SteadyStateDetectorTest passed.\n";
+    return 0;
+}